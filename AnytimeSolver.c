@@ -0,0 +1,68 @@
+/* Anytime mode. The solver always holds a valid solution, starting with the n - 1
+* vertical lines between consecutive points, and replaces it whenever a run ends
+* with fewer lines. The first run is the plain pipeline with the local
+* optimization, the next ones are randomized restarts, until the deadline passes
+* or the requested number of restarts is done. A run checks the deadline in the
+* greedy loop, between the rounds of the redundant line removal and between the
+* local optimization passes; cut short in the greedy it still has connected points
+* and is dropped, cut short later it is a valid solution and is kept. The result
+* is finished when the first run got through every step in time.
+*/
+
+#include <limits.h>
+#include "AnytimeSolver.h"
+#include "MultiStart.h"
+
+void SolveAnytime(Solver *solver)
+{
+	double deadline = GetWallClock() + solver->myTimeLimit;
+	int n = solver->myNumberOfPoints;
+
+	RestartResult best;
+	best.lines = (int *)AllocateStorage(sizeof(int) * 2 * (size_t)(n > 0 ? n : 1));
+	/* the trivial solution loses ties against any run */
+	best.restart = INT_MAX;
+	best.numberOfLines = 0;
+	while (best.numberOfLines < n - 1)
+	{
+		best.lines[best.numberOfLines] = 2 * best.numberOfLines + X;
+		best.numberOfLines++;
+	}
+
+	Solver run;
+	CopySolverSettings(&run, solver);
+	run.myTimeLimit = 0;
+	run.myNumberOfRestarts = 1;
+	run.myRestartWorkers = solver->myRestartWorkers;
+	run.myLocalSearch = 1;
+	run.myDeadline = deadline;
+
+	int isFinished = 0;
+	int restart = 0;
+	while (GetWallClock() < deadline && (solver->myNumberOfRestarts <= 1 || restart < solver->myNumberOfRestarts))
+	{
+		RunRestart(&run, solver, restart);
+		if (!run.myRemainingConnections)
+		{
+			KeepBestSolution(&run, restart, &best);
+		}
+		if (restart == 0)
+		{
+			isFinished = run.myIsFinished;
+		}
+		restart++;
+
+		/* no restart can beat a solution meeting the lower bound */
+		if (best.numberOfLines <= run.myBounds.best)
+		{
+			break;
+		}
+	}
+
+	AdoptSolution(solver, &best);
+	solver->myIsFinished = isFinished;
+	solver->myIsTimedOut = !isFinished;
+	solver->myNumberOfRuns = restart;
+	free(best.lines);
+	FreeSolver(&run);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#ifndef ANYTIME_SOLVER_H
+#define  ANYTIME_SOLVER_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	ANYTIME_REPORT "Anytime %s: %d lines after %d runs, %s\n"
+
+/* Functions */
+void SolveAnytime(Solver *solver);
+
+#endif
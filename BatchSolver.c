@@ -0,0 +1,115 @@
+/* Batch mode. Every input file is an independent task of a work stealing pool,
+* each worker keeps its own solver so that the arena sized by the previous
+* instance is reused for the next one. Files are handed out largest first, so
+* the big instances start early and the small ones fill in around them.
+*/
+
+#include <sys/stat.h>
+#include <limits.h>
+#include "BatchSolver.h"
+#include "RadixSort.h"
+#include "WorkPool.h"
+
+/* Solve one input file with the solver of the worker running it */
+void SolveBatchFile(void *context, int task, int worker)
+{
+	Batch *batch = (Batch *)context;
+	Solver *solver = &batch->solvers[worker];
+	char *fileName = batch->fileNames[task];
+
+	int fileStatus = ReadInputFile(solver, fileName);
+	batch->fileStatus[task] = fileStatus;
+	if (fileStatus != SUCCESS)
+	{
+		ReportFileStatus(fileStatus, fileName);
+		ResetSolverStorage(solver);
+		return;
+	}
+
+	Solve(solver);
+	WriteSolution(solver, fileName, batch->options);
+	ReportSolved(solver, fileName, batch->options);
+	ResetSolverStorage(solver);
+}
+
+/* Get the size of the file in bytes, 0 if it cannot be found */
+long long GetFileSize(char *fileName)
+{
+	struct stat info;
+	if (stat(fileName, &info) != 0)
+	{
+		return (0);
+	}
+	return ((long long)info.st_size);
+}
+
+/* Solve all the files on the given number of workers and report the throughput.
+ * Files that cannot be read are reported and skipped, returns the number of them
+ */
+int SolveBatch(char **fileNames, int numberOfFiles, const Options *options)
+{
+	int numberOfWorkers = options->numberOfWorkers;
+	if (numberOfWorkers < 1)
+	{
+		numberOfWorkers = GetNumberOfCores();
+	}
+	if (numberOfWorkers > numberOfFiles)
+	{
+		numberOfWorkers = numberOfFiles;
+	}
+
+	Batch batch;
+	batch.fileNames = fileNames;
+	batch.numberOfFiles = numberOfFiles;
+	batch.options = options;
+	batch.solvers = (Solver *)AllocateStorage(sizeof(Solver) * numberOfWorkers);
+	batch.fileStatus = (int *)AllocateStorage(sizeof(int) * numberOfFiles);
+
+	/* the largest files go first, in command line order among equal sizes */
+	int *tasks = (int *)AllocateStorage(sizeof(int) * 2 * numberOfFiles);
+	uint64_t *keys = (uint64_t *)AllocateStorage(sizeof(uint64_t) * 2 * numberOfFiles);
+	int index = 0;
+	while (index < numberOfFiles)
+	{
+		tasks[index] = index;
+		keys[index] = (uint64_t)(LLONG_MAX - GetFileSize(fileNames[index]));
+		index++;
+	}
+	RadixSortKeys(keys, tasks, keys + numberOfFiles, tasks + numberOfFiles, (size_t)numberOfFiles, 1);
+
+	index = 0;
+	while (index < numberOfWorkers)
+	{
+		InitializeSolver(&batch.solvers[index], options);
+		index++;
+	}
+
+	double start = GetWallClock();
+	RunWorkPool(numberOfWorkers, tasks, numberOfFiles, &SolveBatchFile, &batch);
+	double elapsed = GetWallClock() - start;
+
+	int failed = 0;
+	index = 0;
+	while (index < numberOfFiles)
+	{
+		if (batch.fileStatus[index] != SUCCESS)
+		{
+			failed++;
+		}
+		index++;
+	}
+	printf(BATCH_SUMMARY, numberOfFiles - failed, numberOfFiles, elapsed,
+		elapsed > 0 ? (numberOfFiles - failed) / elapsed : 0.0);
+
+	index = 0;
+	while (index < numberOfWorkers)
+	{
+		FreeSolver(&batch.solvers[index]);
+		index++;
+	}
+	free(keys);
+	free(tasks);
+	free(batch.fileStatus);
+	free(batch.solvers);
+	return (failed);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#ifndef BATCH_SOLVER_H
+#define  BATCH_SOLVER_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	BATCH_SUMMARY "Solved %d of %d instances in %.3f s, %.1f instances/s\n"
+
+/* Type Definitions */
+
+/* Shared state of a batch run, every worker owns one solver */
+typedef struct batch
+{
+	char **fileNames;
+	int numberOfFiles;
+	const Options *options;
+	Solver *solvers;
+	int *fileStatus;
+} Batch;
+
+/* Functions */
+int SolveBatch(char **fileNames, int numberOfFiles, const Options *options);
+
+#endif
@@ -0,0 +1,401 @@
+/* Benchmark suite. Instances of every family are generated from a fixed seed
+* for n = 10, 30, 100, 300, ... up to the requested size, written as text
+* files and pushed through the same steps as main(), each step timed on its
+* own. Every run prints one CSV row with the phase times, the peak resident
+* memory, the cache misses of the solving phases, read from a hardware counter
+* when the system exposes one, and the number of lines, and every family ends with the scaling
+* exponents of the greedy and optimization phases fitted on log-log scale,
+* so that regressions in complexity show up as well as regressions in time.
+*/
+
+#include <math.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "Benchmark.h"
+
+const char *myFamilyNames[NUMBER_OF_FAMILIES] = { "uniform", "clustered", "grid", "diagonals" };
+
+/* Generate the points of a family. Coordinates are first drawn in a range that leaves
+ * room to append the index of the point, which keeps every x and every y distinct
+ */
+void GenerateInstance(Family family, int numberOfPoints, int *xValues, int *yValues)
+{
+	unsigned long long state = BENCHMARK_SEED ^ ((unsigned long long)family << 32) ^ (unsigned long long)numberOfPoints;
+	long long n = numberOfPoints;
+	long long range = 2147483647LL / n - 1;
+	long long side = (long long)ceil(sqrt((double)n));
+	long long clusters = side / 4 + 1;
+	long long spread = range / (2 * clusters) + 1;
+	long long centerX = 0;
+	long long centerY = 0;
+	long long i = 0;
+	while (i < n)
+	{
+		long long rawX = 0;
+		long long rawY = 0;
+		switch (family)
+		{
+		case UNIFORM_FAMILY:
+			rawX = (long long)(NextRandom(&state) % (unsigned long long)range);
+			rawY = (long long)(NextRandom(&state) % (unsigned long long)range);
+			break;
+
+		case CLUSTERED_FAMILY:
+			/* sensor fields, gaussian like blobs around a few centres */
+			if (i % (n / clusters + 1) == 0)
+			{
+				centerX = (long long)(NextRandom(&state) % (unsigned long long)range);
+				centerY = (long long)(NextRandom(&state) % (unsigned long long)range);
+			}
+			rawX = centerX;
+			rawY = centerY;
+			for (int k = 0; k < 4; k++)
+			{
+				rawX += (long long)(NextRandom(&state) % (unsigned long long)spread) - spread / 2;
+				rawY += (long long)(NextRandom(&state) % (unsigned long long)spread) - spread / 2;
+			}
+			rawX = rawX < 0 ? 0 : (rawX >= range ? range - 1 : rawX);
+			rawY = rawY < 0 ? 0 : (rawY >= range ? range - 1 : rawY);
+			break;
+
+		case GRID_FAMILY:
+		{
+			long long cell = range / side;
+			rawX = (i % side) * cell + cell / 2;
+			rawY = (i / side) * cell + cell / 2;
+			if (cell >= 4)
+			{
+				rawX += (long long)(NextRandom(&state) % (unsigned long long)(cell / 2)) - cell / 4;
+				rawY += (long long)(NextRandom(&state) % (unsigned long long)(cell / 2)) - cell / 4;
+			}
+			break;
+		}
+
+		case DIAGONALS_FAMILY:
+			/* two interleaved ascending diagonals, one above the other. A horizontal line between
+			 * them and a vertical line after every other point, about n / 2 lines, are optimal,
+			 * while the median splits of the greedy end up well above that. The coordinates
+			 * are already distinct ranks
+			 */
+			xValues[i] = (int)i;
+			yValues[i] = (int)((i % 2) * ((n + 1) / 2) + i / 2);
+			i++;
+			continue;
+
+		default: break;
+		}
+		xValues[i] = (int)(rawX * n + i);
+		yValues[i] = (int)(rawY * n + i);
+		i++;
+	}
+}
+
+/* Write the points as a text instance */
+int WriteTextInstance(const char *fileName, const int *xValues, const int *yValues, int numberOfPoints)
+{
+	FILE *out = fopen(fileName, "w");
+	if (out == NULL)
+	{
+		return (FILE_NOT_FOUND);
+	}
+	fprintf(out, "%d\n", numberOfPoints);
+	int i = 0;
+	while (i < numberOfPoints)
+	{
+		fprintf(out, "%d %d\n", xValues[i], yValues[i]);
+		i++;
+	}
+	fclose(out);
+	return (SUCCESS);
+}
+
+/* Clear the peak resident memory of the process, returns 0 if the system cannot */
+int ResetPeakMemory()
+{
+	FILE *refs = fopen("/proc/self/clear_refs", "w");
+	if (refs == NULL)
+	{
+		return (0);
+	}
+	int reset = fputs("5", refs) >= 0;
+	reset = fclose(refs) == 0 && reset;
+	return (reset);
+}
+
+/* Get the peak resident memory in kB, since the last reset when the system supports it */
+long GetPeakMemory()
+{
+	FILE *status = fopen("/proc/self/status", "r");
+	char line[256];
+	long peak = -1;
+	while (status != NULL && fgets(line, sizeof(line), status) != NULL)
+	{
+		if (sscanf(line, "VmHWM: %ld", &peak) == 1)
+		{
+			break;
+		}
+	}
+	if (status != NULL)
+	{
+		fclose(status);
+	}
+	if (peak < 0)
+	{
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		peak = usage.ru_maxrss;
+	}
+	return (peak);
+}
+
+/* Open a counter of the cache misses of the process in user space, threads started later
+ * included. Returns -1 when the system has no such counter or does not allow it
+ */
+int OpenCacheMissCounter()
+{
+#ifdef __linux__
+	struct perf_event_attr attributes;
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+	attributes.disabled = 1;
+	attributes.inherit = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	return ((int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+	return (-1);
+#endif
+}
+
+/* Start counting from zero */
+void StartCacheMissCounter(int counter)
+{
+#ifdef __linux__
+	if (counter >= 0)
+	{
+		(void)ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+		(void)ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#else
+	(void)counter;
+#endif
+}
+
+/* Stop counting, returns the cache misses since the start or -1 without a counter */
+long long StopCacheMissCounter(int counter)
+{
+	long long misses = -1;
+#ifdef __linux__
+	if (counter >= 0)
+	{
+		(void)ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(counter, &misses, sizeof(misses)) != (ssize_t)sizeof(misses))
+		{
+			misses = -1;
+		}
+	}
+#else
+	(void)counter;
+#endif
+	return (misses);
+}
+
+/* Run the pipeline of main() on the instance file, timing every phase. The cache misses are
+ * counted from the sort to the end of the optimization, the phases working on the points
+ */
+int RunBenchmarkInstance(Solver *solver, char *instanceName, const char *solutionName, int counter, BenchmarkRun *run)
+{
+	double phaseStart = GetWallClock();
+	double start = phaseStart;
+	int fileStatus = ReadInputFile(solver, instanceName);
+	if (fileStatus != SUCCESS)
+	{
+		return (fileStatus);
+	}
+	double now = GetWallClock();
+	run->phaseTime[PARSE_PHASE] = now - phaseStart;
+
+	StartCacheMissCounter(counter);
+	phaseStart = now;
+	SortInputPoints(solver);
+	ComputeLowerBounds(solver);
+	now = GetWallClock();
+	run->phaseTime[SORT_PHASE] = now - phaseStart;
+
+	phaseStart = now;
+	InitializePoints(solver);
+	now = GetWallClock();
+	run->phaseTime[INITIALIZE_PHASE] = now - phaseStart;
+
+	phaseStart = now;
+	AddLines(solver, X, 0, solver->myNumberOfPoints - 1);
+	AddLines(solver, Y, 0, solver->myNumberOfPoints - 1);
+	now = GetWallClock();
+	run->phaseTime[CANDIDATE_PHASE] = now - phaseStart;
+
+	phaseStart = now;
+	CommitGreedyLines(solver);
+	now = GetWallClock();
+	run->phaseTime[GREEDY_PHASE] = now - phaseStart;
+
+	phaseStart = now;
+	ImproveSolution(solver);
+	now = GetWallClock();
+	run->phaseTime[OPTIMIZE_PHASE] = now - phaseStart;
+	run->cacheMisses = StopCacheMissCounter(counter);
+
+	phaseStart = now;
+	WriteSolutionFile(solver, solutionName);
+	now = GetWallClock();
+	run->phaseTime[WRITE_PHASE] = now - phaseStart;
+
+	run->totalTime = now - start;
+	run->numberOfLines = CountCommittedLines(solver);
+	run->lowerBound = solver->myBounds.best;
+	return (SUCCESS);
+}
+
+/* Fit the exponent k of time = c * n^k by least squares on log-log scale, NAN without enough points */
+double FitScalingExponent(const BenchmarkRun *runs, int numberOfRuns, int phase)
+{
+	double sumX = 0;
+	double sumY = 0;
+	double sumXX = 0;
+	double sumXY = 0;
+	int count = 0;
+	int i = 0;
+	while (i < numberOfRuns)
+	{
+		double time = phase < 0 ? runs[i].totalTime : runs[i].phaseTime[phase];
+		if (runs[i].numberOfPoints >= BENCHMARK_FIT_MIN_POINTS && time >= BENCHMARK_FIT_MIN_TIME)
+		{
+			double x = log((double)runs[i].numberOfPoints);
+			double y = log(time);
+			sumX += x;
+			sumY += y;
+			sumXX += x * x;
+			sumXY += x * y;
+			count++;
+		}
+		i++;
+	}
+	if (count < 2 || count * sumXX - sumX * sumX <= 0)
+	{
+		return (NAN);
+	}
+	return ((count * sumXY - sumX * sumY) / (count * sumXX - sumX * sumX));
+}
+
+/* Run every family from 10 points up to maxPoints and print the measures as CSV.
+ * Returns 1 if an instance could not be created
+ */
+int RunBenchmark(int maxPoints, const Options *options)
+{
+	char instanceName[] = "/tmp/separating_lines_benchmarkXXXXXX";
+	int fd = mkstemp(instanceName);
+	if (fd < 0)
+	{
+		(void)fprintf(stderr, BENCHMARK_TEMP_ERR, instanceName);
+		return (1);
+	}
+	close(fd);
+	char solutionName[sizeof(instanceName) + 9];
+	sprintf(solutionName, "%s.solution", instanceName);
+
+	int *xValues = (int *)AllocateStorage(sizeof(int) * (size_t)maxPoints);
+	int *yValues = (int *)AllocateStorage(sizeof(int) * (size_t)maxPoints);
+	BenchmarkRun runs[64];
+	Solver solver;
+	int counter = OpenCacheMissCounter();
+
+	if (options->numberOfRestarts > 1 || options->timeLimit > 0 || options->isExact || options->numberOfParts > 1)
+	{
+		printf(BENCHMARK_IGNORED_NOTE);
+	}
+	printf("family,points");
+	for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+	{
+		printf(",%s_ms", myPhaseNames[phase]);
+	}
+	printf(",total_ms,peak_rss_kb,cache_misses,lines,lower_bound\n");
+
+	int failed = 0;
+	for (int family = 0; family < NUMBER_OF_FAMILIES && !failed; family++)
+	{
+		int numberOfRuns = 0;
+		long long size = BENCHMARK_MIN_POINTS;
+		int step = 0;
+		while (size <= maxPoints && numberOfRuns < 64)
+		{
+			int n = (int)size;
+			size = step % 2 == 0 ? size * 3 : size / 3 * 10;
+			step++;
+			if (options->engine == PAIRWISE_ENGINE && n > BENCHMARK_PAIRWISE_LIMIT)
+			{
+				continue;
+			}
+
+			GenerateInstance((Family)family, n, xValues, yValues);
+			if (WriteTextInstance(instanceName, xValues, yValues, n) != SUCCESS)
+			{
+				(void)fprintf(stderr, BENCHMARK_TEMP_ERR, instanceName);
+				failed = 1;
+				break;
+			}
+
+			BenchmarkRun *run = &runs[numberOfRuns];
+			memset(run, 0, sizeof(BenchmarkRun));
+			run->numberOfPoints = n;
+			(void)ResetPeakMemory();
+			InitializeSolver(&solver, options);
+			int fileStatus = RunBenchmarkInstance(&solver, instanceName, solutionName, counter, run);
+			run->peakMemory = GetPeakMemory();
+			FreeSolver(&solver);
+			if (fileStatus != SUCCESS)
+			{
+				ReportFileStatus(fileStatus, instanceName);
+				failed = 1;
+				break;
+			}
+
+			printf("%s,%d", myFamilyNames[family], n);
+			for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+			{
+				printf(",%.3f", run->phaseTime[phase] * 1000);
+			}
+			printf(",%.3f,%ld", run->totalTime * 1000, run->peakMemory);
+			if (run->cacheMisses >= 0)
+			{
+				printf(",%lld", run->cacheMisses);
+			}
+			else
+			{
+				printf(",n/a");
+			}
+			printf(",%d,%d\n", run->numberOfLines, run->lowerBound);
+			fflush(stdout);
+			numberOfRuns++;
+		}
+		printf("# %s scaling exponents: greedy %.2f, optimize %.2f, total %.2f\n", myFamilyNames[family],
+			FitScalingExponent(runs, numberOfRuns, GREEDY_PHASE),
+			FitScalingExponent(runs, numberOfRuns, OPTIMIZE_PHASE),
+			FitScalingExponent(runs, numberOfRuns, -1));
+	}
+
+	if (counter >= 0)
+	{
+		close(counter);
+	}
+	(void)remove(instanceName);
+	(void)remove(solutionName);
+	free(yValues);
+	free(xValues);
+	return (failed);
+}
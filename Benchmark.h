@@ -0,0 +1,53 @@
+#pragma once
+#ifndef BENCHMARK_H
+#define  BENCHMARK_H
+
+/* Includes */
+#include "SeparatingLines.h"
+#include "LowerBounds.h"
+
+/* Definitions */
+#define	BENCHMARK_SEED	0x5EBA7A7E5ULL
+#define	BENCHMARK_MIN_POINTS	10
+
+/* Largest instance run with the pairwise engine, its matrix grows with n^2 */
+#define	BENCHMARK_PAIRWISE_LIMIT	5000
+
+/* Smallest instance and phase time taken into the fit of the scaling exponents */
+#define	BENCHMARK_FIT_MIN_POINTS	1000
+#define	BENCHMARK_FIT_MIN_TIME	1e-4
+
+#define	BENCHMARK_TEMP_ERR "Unable to create the benchmark instance in %s\n"
+#define	BENCHMARK_IGNORED_NOTE "# -r, -t, -x and -p are ignored, the benchmark times the plain pipeline phase by phase\n"
+
+/* Type Definitions */
+
+/* Reproducible instance families */
+typedef enum family
+{
+	UNIFORM_FAMILY,
+	CLUSTERED_FAMILY,
+	GRID_FAMILY,
+	DIAGONALS_FAMILY,
+	NUMBER_OF_FAMILIES
+} Family;
+
+/* Measures of one instance */
+typedef struct benchmarkRun
+{
+	int numberOfPoints;
+	double phaseTime[NUMBER_OF_PHASES];
+	double totalTime;
+	long peakMemory;
+
+	/* Cache misses of the solving phases, -1 when they cannot be counted */
+	long long cacheMisses;
+	int numberOfLines;
+	int lowerBound;
+} BenchmarkRun;
+
+/* Functions */
+void GenerateInstance(Family family, int numberOfPoints, int *xValues, int *yValues);
+int RunBenchmark(int maxPoints, const Options *options);
+
+#endif
@@ -0,0 +1,452 @@
+/* Binary point set and solution files. Both start with a 64 byte header and
+* store their data as little endian columns aligned to cache lines, so on a
+* little endian host a mapped file can be used in place. The converter moves instances and solutions between these
+* files and the text formats read by ReadInputFile and written by
+* WriteOutputFile.
+*/
+
+#include <limits.h>
+#include <math.h>
+#include "BinaryFormat.h"
+#include "InstanceParser.h"
+
+/* Round the size of a column up to the column alignment */
+size_t GetColumnBytes(size_t size)
+{
+	return (size + BINARY_COLUMN_ALIGNMENT - 1) / BINARY_COLUMN_ALIGNMENT * BINARY_COLUMN_ALIGNMENT;
+}
+
+/* Read an unsigned little endian integer of the given width in bytes */
+uint64_t LoadLittleEndian(const char *bytes, size_t width)
+{
+	uint64_t value = 0;
+	size_t index = width;
+	while (index > 0)
+	{
+		index--;
+		value = value << 8 | (uint8_t)bytes[index];
+	}
+	return (value);
+}
+
+/* Write the low width bytes of the value in little endian */
+void StoreLittleEndian(char *bytes, uint64_t value, size_t width)
+{
+	size_t index = 0;
+	while (index < width)
+	{
+		bytes[index] = (char)(uint8_t)(value >> (8 * index));
+		index++;
+	}
+}
+
+/* Turn a column of count host integers of the given width into little endian, in place */
+void StoreLittleEndianColumn(void *column, size_t width, size_t count)
+{
+	char *bytes = (char *)column;
+	size_t index = 0;
+	while (index < count)
+	{
+		uint64_t value;
+		if (width == sizeof(uint32_t))
+		{
+			uint32_t item;
+			memcpy(&item, bytes, sizeof(uint32_t));
+			value = item;
+		}
+		else
+		{
+			memcpy(&value, bytes, sizeof(uint64_t));
+		}
+		StoreLittleEndian(bytes, value, width);
+		bytes += width;
+		index++;
+	}
+}
+
+/* Check if the text starts with the header of the given kind */
+int IsBinaryFormat(const char *text, size_t length, const char *magic)
+{
+	return (length >= BINARY_HEADER_BYTES && memcmp(text, magic, 4) == 0);
+}
+
+/* Check the header and return the number of items, -1 if it is not valid for the file length */
+long long ReadBinaryHeader(const char *text, size_t length, const char *magic, BinaryHeader *header)
+{
+	if (!IsBinaryFormat(text, length, magic))
+	{
+		return (-1);
+	}
+	memset(header, 0, sizeof(BinaryHeader));
+	memcpy(header->magic, text, 4);
+	header->version = (uint32_t)LoadLittleEndian(text + 4, sizeof(uint32_t));
+	header->coordinateBytes = (uint32_t)LoadLittleEndian(text + 8, sizeof(uint32_t));
+	header->reserved = (uint32_t)LoadLittleEndian(text + 12, sizeof(uint32_t));
+	header->count = LoadLittleEndian(text + 16, sizeof(uint64_t));
+	if (header->version != BINARY_FORMAT_VERSION || header->count > INT_MAX)
+	{
+		return (-1);
+	}
+	return ((long long)header->count);
+}
+
+/* Read one coordinate of a 4 or 8 byte column, 0 if it does not fit an int */
+int ReadCoordinate(const char *column, size_t index, uint32_t coordinateBytes, int *value)
+{
+	if (coordinateBytes == sizeof(int32_t))
+	{
+		*value = (int32_t)(uint32_t)LoadLittleEndian(column + index * sizeof(int32_t), sizeof(int32_t));
+		return (1);
+	}
+	int64_t coordinate = (int64_t)LoadLittleEndian(column + index * sizeof(int64_t), sizeof(int64_t));
+	if (coordinate < INT_MIN || coordinate > INT_MAX)
+	{
+		return (0);
+	}
+	*value = (int)coordinate;
+	return (1);
+}
+
+/* Load a binary point set into the solver storage */
+int ParseBinaryInstance(Solver *solver, const char *text, size_t length)
+{
+	BinaryHeader header;
+	long long count = ReadBinaryHeader(text, length, POINT_SET_MAGIC, &header);
+	if (count < 0 || (header.coordinateBytes != sizeof(int32_t) && header.coordinateBytes != sizeof(int64_t)))
+	{
+		return (BAD_FORMAT);
+	}
+	if (count == 0)
+	{
+		return (NO_POINTS);
+	}
+	size_t columnBytes = GetColumnBytes((size_t)count * header.coordinateBytes);
+	if (length != BINARY_HEADER_BYTES + 2 * columnBytes)
+	{
+		return (POINTS_MORE_LESS);
+	}
+
+	int numberOfPoints = (int)count;
+	solver->myNumberOfPoints = numberOfPoints;
+	AllocateSolverStorage(solver, numberOfPoints);
+
+	const char *xColumn = text + BINARY_HEADER_BYTES;
+	const char *yColumn = xColumn + columnBytes;
+	int i = 0;
+	while (i < numberOfPoints)
+	{
+		if (!ReadCoordinate(xColumn, (size_t)i, header.coordinateBytes, &solver->myValues[X][i]) ||
+			!ReadCoordinate(yColumn, (size_t)i, header.coordinateBytes, &solver->myValues[Y][i]))
+		{
+			return (BAD_FORMAT);
+		}
+		i++;
+	}
+	return (SUCCESS);
+}
+
+/* Write the header of a binary file */
+void WriteBinaryHeader(FILE *out, const char *magic, uint32_t coordinateBytes, size_t count)
+{
+	char header[BINARY_HEADER_BYTES];
+	memset(header, 0, sizeof(header));
+	memcpy(header, magic, 4);
+	StoreLittleEndian(header + 4, BINARY_FORMAT_VERSION, sizeof(uint32_t));
+	StoreLittleEndian(header + 8, coordinateBytes, sizeof(uint32_t));
+	StoreLittleEndian(header + 16, count, sizeof(uint64_t));
+	(void)fwrite(header, sizeof(header), 1, out);
+}
+
+/* Write a column followed by the zero padding up to the column alignment */
+void WriteColumn(FILE *out, const void *column, size_t size)
+{
+	static const char padding[BINARY_COLUMN_ALIGNMENT];
+	(void)fwrite(column, 1, size, out);
+	(void)fwrite(padding, 1, GetColumnBytes(size) - size, out);
+}
+
+/* Write a binary solution from its axis bitmap and doubled coordinates, the coordinates are turned to little endian */
+int WriteBinarySolutionColumns(char *solutionName, const uint8_t *axes, int64_t *coordinates, size_t count)
+{
+	FILE *out = fopen(solutionName, "wb");
+	if (out == NULL)
+	{
+		return (FILE_NOT_FOUND);
+	}
+	WriteBinaryHeader(out, SOLUTION_MAGIC, sizeof(int64_t), count);
+	StoreLittleEndianColumn(coordinates, sizeof(int64_t), count);
+	WriteColumn(out, axes, (count + 7) / 8);
+	WriteColumn(out, coordinates, count * sizeof(int64_t));
+	fclose(out);
+	return (SUCCESS);
+}
+
+/* Write the committed lines to greedy_solutionNN.bin */
+void WriteBinarySolution(Solver *solver, char *fileName)
+{
+	char solutionName[255];
+	GetSolutionFileName(fileName, solutionName, BINARY_SOLUTION_SUFFIX);
+
+	size_t count = 0;
+	uint8_t *axes = (uint8_t *)ArenaAlloc(&solver->myArena, (size_t)solver->myNumberOfLines / 8 + 1);
+	int64_t *coordinates = (int64_t *)ArenaAlloc(&solver->myArena, sizeof(int64_t) * ((size_t)solver->myNumberOfLines + 1));
+	memset(axes, 0, (size_t)solver->myNumberOfLines / 8 + 1);
+	int i = 0;
+	while (i < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[i];
+		if (l->isCommitted)
+		{
+			if (l->lineAxis == Y)
+			{
+				axes[count / 8] |= (uint8_t)(1 << (count % 8));
+			}
+			coordinates[count++] = GetDoubledIntersectionValue(solver, l);
+		}
+		i++;
+	}
+	(void)WriteBinarySolutionColumns(solutionName, axes, coordinates, count);
+}
+
+/* Skip whitespace and return the next character of the text, 0 at the end */
+char PeekToken(const char **cursor, const char *end)
+{
+	while (*cursor < end && IS_BLANK(**cursor))
+	{
+		(*cursor)++;
+	}
+	return (*cursor < end ? **cursor : 0);
+}
+
+/* Scan a decimal number and return twice its value. A value strictly between two integers
+ * separates the points exactly as the half integer between them, which is returned instead,
+ * so no line is ever rounded onto the points
+ */
+int ScanDoubledCoordinate(const char **cursor, const char *end, int64_t *value)
+{
+	char token[64];
+	size_t length = 0;
+	(void)PeekToken(cursor, end);
+	while (*cursor < end && !IS_BLANK(**cursor) && length < sizeof(token) - 1)
+	{
+		token[length++] = *(*cursor)++;
+	}
+	token[length] = '\0';
+	char *parsed;
+	double coordinate = strtod(token, &parsed);
+	if (length == 0 || *parsed != '\0' || !(fabs(coordinate) < (double)INT64_MAX / 4))
+	{
+		return (0);
+	}
+	double doubled = coordinate * 2;
+	if (doubled != floor(doubled))
+	{
+		doubled = 2 * floor(coordinate) + 1;
+	}
+	*value = (int64_t)doubled;
+	return (1);
+}
+
+/* Convert a text point set into a binary one */
+int ConvertTextPoints(const char *cursor, const char *end, FILE *out)
+{
+	int count;
+	if (!ScanInteger(&cursor, end, &count) || count <= 0)
+	{
+		return (NO_POINTS);
+	}
+	if ((size_t)count > (size_t)(end - cursor) / MIN_POINT_BYTES + 1)
+	{
+		return (POINTS_MORE_LESS);
+	}
+	int32_t *columns = (int32_t *)AllocateStorage(sizeof(int32_t) * 2 * (size_t)count);
+	int i = 0;
+	while (i < count)
+	{
+		int x;
+		int y;
+		if (!ScanInteger(&cursor, end, &x) || !ScanInteger(&cursor, end, &y))
+		{
+			free(columns);
+			return (POINTS_MORE_LESS);
+		}
+		columns[i] = x;
+		columns[count + i] = y;
+		i++;
+	}
+	if (PeekToken(&cursor, end))
+	{
+		free(columns);
+		return (POINTS_MORE_LESS);
+	}
+	WriteBinaryHeader(out, POINT_SET_MAGIC, sizeof(int32_t), (size_t)count);
+	StoreLittleEndianColumn(columns, sizeof(int32_t), 2 * (size_t)count);
+	WriteColumn(out, columns, sizeof(int32_t) * (size_t)count);
+	WriteColumn(out, columns + count, sizeof(int32_t) * (size_t)count);
+	free(columns);
+	return (SUCCESS);
+}
+
+/* Convert a text solution, the line count followed by "v x" and "h y" lines, into a binary one */
+int ConvertTextSolution(const char *cursor, const char *end, char *outputName)
+{
+	int count;
+	if (!ScanInteger(&cursor, end, &count) || count < 0)
+	{
+		return (BAD_FORMAT);
+	}
+	if ((size_t)count > (size_t)(end - cursor) / MIN_POINT_BYTES + 1)
+	{
+		return (BAD_FORMAT);
+	}
+	uint8_t *axes = (uint8_t *)AllocateClearedStorage((size_t)count / 8 + 1, 1);
+	int64_t *coordinates = (int64_t *)AllocateStorage(sizeof(int64_t) * ((size_t)count + 1));
+	int fileStatus = SUCCESS;
+	int i = 0;
+	while (i < count && fileStatus == SUCCESS)
+	{
+		char axis = PeekToken(&cursor, end);
+		if (axis != 'v' && axis != 'h')
+		{
+			fileStatus = BAD_FORMAT;
+			break;
+		}
+		cursor++;
+		if (!ScanDoubledCoordinate(&cursor, end, &coordinates[i]))
+		{
+			fileStatus = BAD_FORMAT;
+		}
+		if (axis == 'h')
+		{
+			axes[i / 8] |= (uint8_t)(1 << (i % 8));
+		}
+		i++;
+	}
+	if (fileStatus == SUCCESS && PeekToken(&cursor, end))
+	{
+		fileStatus = BAD_FORMAT;
+	}
+	if (fileStatus == SUCCESS)
+	{
+		fileStatus = WriteBinarySolutionColumns(outputName, axes, coordinates, (size_t)count);
+	}
+	free(coordinates);
+	free(axes);
+	return (fileStatus);
+}
+
+/* Convert a binary point set into the text format */
+int ConvertBinaryPoints(const char *text, size_t length, FILE *out)
+{
+	BinaryHeader header;
+	long long count = ReadBinaryHeader(text, length, POINT_SET_MAGIC, &header);
+	if (count < 0 || (header.coordinateBytes != sizeof(int32_t) && header.coordinateBytes != sizeof(int64_t)))
+	{
+		return (BAD_FORMAT);
+	}
+	size_t columnBytes = GetColumnBytes((size_t)count * header.coordinateBytes);
+	if (length != BINARY_HEADER_BYTES + 2 * columnBytes)
+	{
+		return (POINTS_MORE_LESS);
+	}
+	const char *xColumn = text + BINARY_HEADER_BYTES;
+	const char *yColumn = xColumn + columnBytes;
+	fprintf(out, "%lld\n", count);
+	size_t i = 0;
+	while (i < (size_t)count)
+	{
+		int x;
+		int y;
+		if (!ReadCoordinate(xColumn, i, header.coordinateBytes, &x) || !ReadCoordinate(yColumn, i, header.coordinateBytes, &y))
+		{
+			return (BAD_FORMAT);
+		}
+		fprintf(out, "%d %d\n", x, y);
+		i++;
+	}
+	return (SUCCESS);
+}
+
+/* Convert a binary solution into the text format written by WriteOutputFile */
+int ConvertBinarySolution(const char *text, size_t length, FILE *out)
+{
+	BinaryHeader header;
+	long long count = ReadBinaryHeader(text, length, SOLUTION_MAGIC, &header);
+	if (count < 0 || header.coordinateBytes != sizeof(int64_t))
+	{
+		return (BAD_FORMAT);
+	}
+	size_t axesBytes = GetColumnBytes((size_t)(count + 7) / 8);
+	if (length != BINARY_HEADER_BYTES + axesBytes + GetColumnBytes((size_t)count * sizeof(int64_t)))
+	{
+		return (BAD_FORMAT);
+	}
+	const uint8_t *axes = (const uint8_t *)(text + BINARY_HEADER_BYTES);
+	const char *coordinates = text + BINARY_HEADER_BYTES + axesBytes;
+	fprintf(out, "%lld\n", count);
+	size_t i = 0;
+	while (i < (size_t)count)
+	{
+		int64_t doubled = (int64_t)LoadLittleEndian(coordinates + i * sizeof(int64_t), sizeof(int64_t));
+		fprintf(out, "%c %f\n", (axes[i / 8] >> (i % 8) & 1) ? 'h' : 'v', (double)doubled / 2);
+		i++;
+	}
+	return (SUCCESS);
+}
+
+/* Convert between the text and binary formats, the direction and the kind of file
+ * (point set or solution) are taken from the input file
+ */
+int ConvertFile(char *inputName, char *outputName)
+{
+	InstanceText text;
+	int fileStatus = OpenInstanceText(&text, inputName);
+	if (fileStatus != SUCCESS)
+	{
+		return (fileStatus);
+	}
+	size_t length = (size_t)(text.end - text.begin);
+	const char *cursor = text.begin;
+	int count;
+
+	/* a text solution has an axis letter right after its line count */
+	int isTextSolution = 0;
+	if (ScanInteger(&cursor, text.end, &count))
+	{
+		char next = PeekToken(&cursor, text.end);
+		isTextSolution = next == 'v' || next == 'h' || next == 0;
+	}
+
+	if (isTextSolution)
+	{
+		fileStatus = ConvertTextSolution(text.begin, text.end, outputName);
+		CloseInstanceText(&text);
+		return (fileStatus);
+	}
+
+	FILE *out = fopen(outputName, "wb");
+	if (out == NULL)
+	{
+		CloseInstanceText(&text);
+		return (FILE_NOT_FOUND);
+	}
+	if (IsBinaryFormat(text.begin, length, POINT_SET_MAGIC))
+	{
+		fileStatus = ConvertBinaryPoints(text.begin, length, out);
+	}
+	else if (IsBinaryFormat(text.begin, length, SOLUTION_MAGIC))
+	{
+		fileStatus = ConvertBinarySolution(text.begin, length, out);
+	}
+	else
+	{
+		fileStatus = ConvertTextPoints(text.begin, text.end, out);
+	}
+	fclose(out);
+	CloseInstanceText(&text);
+	if (fileStatus != SUCCESS)
+	{
+		(void)remove(outputName);
+	}
+	return (fileStatus);
+}
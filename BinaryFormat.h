@@ -0,0 +1,52 @@
+#pragma once
+#ifndef BINARY_FORMAT_H
+#define  BINARY_FORMAT_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	POINT_SET_MAGIC	"SLPT"
+#define	SOLUTION_MAGIC	"SLSO"
+#define	BINARY_FORMAT_VERSION	1
+#define	BINARY_SOLUTION_SUFFIX	".bin"
+#define	CONVERT_ERR "Unable to convert %s into %s\n"
+
+/* The header fills a cache line so that every column starts on one */
+#define	BINARY_HEADER_BYTES	64
+#define	BINARY_COLUMN_ALIGNMENT	64
+
+/* Type Definitions */
+
+/* Header shared by the point set and the solution files. Every field and every
+ * column item is stored in little endian whatever the byte order of the host.
+ * A point set is followed by the x column and the y column of count coordinates of
+ * coordinateBytes each (4 or 8). A solution is followed by a bitmap of count bits,
+ * bit i set when line i is horizontal, and a column of count 8 byte coordinates
+ * holding twice the coordinate of every line, which is exact since lines lie halfway
+ * between integer coordinates. Every column is padded to a multiple of 64 bytes
+ */
+typedef struct binaryHeader
+{
+	char	magic[4];
+	uint32_t	version;
+	uint32_t	coordinateBytes;
+	uint32_t	reserved;
+	uint64_t	count;
+	uint8_t	padding[BINARY_HEADER_BYTES - 24];
+} BinaryHeader;
+
+/* Functions */
+size_t GetColumnBytes(size_t size);
+uint64_t LoadLittleEndian(const char *bytes, size_t width);
+void StoreLittleEndian(char *bytes, uint64_t value, size_t width);
+void StoreLittleEndianColumn(void *column, size_t width, size_t count);
+long long ReadBinaryHeader(const char *text, size_t length, const char *magic, BinaryHeader *header);
+int IsBinaryFormat(const char *text, size_t length, const char *magic);
+char PeekToken(const char **cursor, const char *end);
+int ScanDoubledCoordinate(const char **cursor, const char *end, int64_t *value);
+int ParseBinaryInstance(Solver *solver, const char *text, size_t length);
+void WriteBinarySolution(Solver *solver, char *fileName);
+int ConvertFile(char *inputName, char *outputName);
+
+#endif
@@ -0,0 +1,480 @@
+/* Exact solver. A branch and bound over the candidate gaps of both axes, seeded
+* with the greedy solution as the incumbent. A node is a set of committed gaps and
+* a set of excluded gaps, kept as bitsets. The node scans the points in the order
+* of each axis to find the pairs of consecutive points sharing a cell, branches on
+* the pair with the fewest available gaps between them and gives child i the i-th
+* of these gaps while excluding the ones before it, so no solution is visited
+* twice. Pairs with no common available gap need a line each, a greedy packing of
+* them bounds the node from below. A point alone in its cell never shares it
+* again, the gaps on both of its sides separate the same pairs and only the first
+* one is branched on. The first levels of the tree are dealt to the work pool as
+* subtrees, the workers share the best solution and prune against it.
+*/
+
+#include <limits.h>
+#include "ExactSolver.h"
+#include "WorkPool.h"
+#include "LowerBounds.h"
+
+int IsGapSet(const ConnectionWord *gaps, int gap)
+{
+	return ((int)(gaps[gap / CONNECTION_WORD_BITS] >> (gap % CONNECTION_WORD_BITS) & 1));
+}
+
+void SetGap(ConnectionWord *gaps, int gap)
+{
+	gaps[gap / CONNECTION_WORD_BITS] |= (ConnectionWord)1 << (gap % CONNECTION_WORD_BITS);
+}
+
+void ClearGap(ConnectionWord *gaps, int gap)
+{
+	gaps[gap / CONNECTION_WORD_BITS] &= ~((ConnectionWord)1 << (gap % CONNECTION_WORD_BITS));
+}
+
+/* Number the bands of every rank and count the available gaps below it, along each axis */
+void ComputeNodeBands(ExactSearch *search)
+{
+	int n = search->shared->solver->myNumberOfPoints;
+	int axis = X;
+	while (axis <= Y)
+	{
+		int band = 0;
+		int available = 0;
+		int rank = 0;
+		while (rank < n)
+		{
+			search->bandOfRank[axis][rank] = band;
+			search->availableBelow[axis][rank] = available;
+			if (rank < n - 1)
+			{
+				if (IsGapSet(search->committed[axis], rank))
+				{
+					band++;
+				}
+				else if (!IsGapSet(search->excluded[axis], rank))
+				{
+					available++;
+				}
+			}
+			rank++;
+		}
+		axis++;
+	}
+}
+
+/* Scan the points in the order of the axis for consecutive points sharing a cell. Keeps the pair
+ * with the fewest available gaps, returns the size of a packing of pairs without a common
+ * available gap, or -1 when some pair cannot be separated anymore
+ */
+int ScanNodePairs(ExactSearch *search, int axis, ExactPair *best, int *numberOfPairs)
+{
+	Solver *solver = search->shared->solver;
+	const int *otherRanks = solver->myOtherRanks[axis];
+	int other = axis == X ? Y : X;
+	int n = solver->myNumberOfPoints;
+
+	if (search->epoch == INT_MAX)
+	{
+		memset(search->bandMark, 0, sizeof(int) * (size_t)n);
+		memset(search->gapMark, 0, sizeof(int) * (size_t)n);
+		search->epoch = 0;
+	}
+	search->epoch++;
+	int packing = 0;
+	int lastEnd = -1;
+	int rank = 0;
+	while (rank < n)
+	{
+		int otherRank = otherRanks[rank];
+		int band = search->bandOfRank[other][otherRank];
+		int ownBand = search->bandOfRank[axis][rank];
+		if (search->bandMark[band] == search->epoch && search->lastBand[band] == ownBand)
+		{
+			int previousRank = search->lastRank[band];
+			int previousOther = otherRanks[previousRank];
+			int lowOther = previousOther < otherRank ? previousOther : otherRank;
+			int highOther = previousOther < otherRank ? otherRank : previousOther;
+			int coverage = search->availableBelow[axis][rank] - search->availableBelow[axis][previousRank] +
+				search->availableBelow[other][highOther] - search->availableBelow[other][lowOther];
+			if (coverage == 0)
+			{
+				return (-1);
+			}
+			(*numberOfPairs)++;
+			if (axis == X)
+			{
+				search->hasMate[previousRank] = 1;
+				search->hasMate[rank] = 1;
+			}
+			if (coverage < best->coverage)
+			{
+				best->lowRank[axis] = previousRank;
+				best->highRank[axis] = rank;
+				best->lowRank[other] = lowOther;
+				best->highRank[other] = highOther;
+				best->coverage = coverage;
+			}
+
+			/* the pairs come by their end along the axis, take the ones clear of the packing on both axes */
+			if (previousRank > lastEnd)
+			{
+				int gap = lowOther;
+				while (gap < highOther && search->gapMark[gap] != search->epoch)
+				{
+					gap++;
+				}
+				if (gap == highOther)
+				{
+					gap = lowOther;
+					while (gap < highOther)
+					{
+						search->gapMark[gap++] = search->epoch;
+					}
+					lastEnd = rank - 1;
+					packing++;
+				}
+			}
+		}
+		search->bandMark[band] = search->epoch;
+		search->lastBand[band] = ownBand;
+		search->lastRank[band] = rank;
+		rank++;
+	}
+	return (packing);
+}
+
+/* Record the solution of the node if it beats the best one */
+void KeepExactSolution(ExactSearch *search)
+{
+	ExactShared *shared = search->shared;
+	pthread_mutex_lock(&shared->lock);
+	if (search->numberOfLines < shared->bestNumberOfLines)
+	{
+		memcpy(shared->bestCommitted[X], search->committed[X], sizeof(ConnectionWord) * (size_t)shared->words);
+		memcpy(shared->bestCommitted[Y], search->committed[Y], sizeof(ConnectionWord) * (size_t)shared->words);
+		__atomic_store_n(&shared->bestNumberOfLines, search->numberOfLines, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&shared->lock);
+}
+
+/* Store the node as a subtree for the work pool */
+void AddFrontierNode(ExactSearch *search)
+{
+	ExactShared *shared = search->shared;
+	size_t words = (size_t)shared->words;
+	if (shared->frontierSize == shared->frontierCapacity)
+	{
+		shared->frontierCapacity = shared->frontierCapacity > 0 ? 2 * shared->frontierCapacity : 64;
+		shared->frontier = (ExactNode *)ResizeStorage(shared->frontier, sizeof(ExactNode) * (size_t)shared->frontierCapacity);
+	}
+	ExactNode *node = &shared->frontier[shared->frontierSize++];
+	ConnectionWord *bits = (ConnectionWord *)AllocateStorage(sizeof(ConnectionWord) * 4 * words);
+	node->committed[X] = bits;
+	node->committed[Y] = bits + words;
+	node->excluded[X] = bits + 2 * words;
+	node->excluded[Y] = bits + 3 * words;
+	memcpy(bits, search->committed[X], sizeof(ConnectionWord) * words);
+	memcpy(bits + words, search->committed[Y], sizeof(ConnectionWord) * words);
+	memcpy(bits + 2 * words, search->excluded[X], sizeof(ConnectionWord) * words);
+	memcpy(bits + 3 * words, search->excluded[Y], sizeof(ConnectionWord) * words);
+	node->numberOfLines = search->numberOfLines;
+}
+
+/* Push the available gaps between the points of the pair, marking the ones equivalent to the gap before them */
+void PushBranches(ExactSearch *search, const ExactPair *pair)
+{
+	Solver *solver = search->shared->solver;
+	int needed = search->branchTop + pair->coverage;
+	if (needed > search->branchCapacity)
+	{
+		search->branchCapacity = 2 * needed;
+		search->branches = (int *)ResizeStorage(search->branches, sizeof(int) * (size_t)search->branchCapacity);
+	}
+	int axis = X;
+	while (axis <= Y)
+	{
+		int gap = pair->lowRank[axis];
+		while (gap < pair->highRank[axis])
+		{
+			if (!IsGapSet(search->excluded[axis], gap))
+			{
+				int xRank = axis == X ? gap : solver->myOtherRanks[Y][gap];
+				int isSkipped = gap > pair->lowRank[axis] && !IsGapSet(search->excluded[axis], gap - 1) && !search->hasMate[xRank];
+				search->branches[search->branchTop++] = 4 * gap + 2 * isSkipped + axis;
+			}
+			gap++;
+		}
+		axis++;
+	}
+}
+
+void SearchNode(ExactSearch *search, int depth)
+{
+	ExactShared *shared = search->shared;
+	search->numberOfNodes++;
+	if (shared->deadline > 0 && search->numberOfNodes % EXACT_DEADLINE_NODES == 0 && GetWallClock() >= shared->deadline)
+	{
+		__atomic_store_n(&shared->isTimedOut, 1, __ATOMIC_RELAXED);
+	}
+	if (__atomic_load_n(&shared->isTimedOut, __ATOMIC_RELAXED))
+	{
+		return;
+	}
+
+	ComputeNodeBands(search);
+	memset(search->hasMate, 0, sizeof(int) * (size_t)shared->solver->myNumberOfPoints);
+	ExactPair pair;
+	pair.coverage = INT_MAX;
+	int numberOfPairs = 0;
+	int packing = ScanNodePairs(search, X, &pair, &numberOfPairs);
+	if (packing < 0)
+	{
+		return;
+	}
+	if (numberOfPairs == 0)
+	{
+		KeepExactSolution(search);
+		return;
+	}
+	int packingY = ScanNodePairs(search, Y, &pair, &numberOfPairs);
+	if (packingY > packing)
+	{
+		packing = packingY;
+	}
+	if (packingY < 0 || search->numberOfLines + packing >= __atomic_load_n(&shared->bestNumberOfLines, __ATOMIC_RELAXED))
+	{
+		return;
+	}
+	if (depth == search->frontierDepth)
+	{
+		AddFrontierNode(search);
+		return;
+	}
+
+	int first = search->branchTop;
+	PushBranches(search, &pair);
+	int last = search->branchTop;
+	int index = first;
+	while (index < last)
+	{
+		int branch = search->branches[index];
+		int axis = branch & 1;
+		int gap = branch >> 2;
+		if (!(branch & 2))
+		{
+			SetGap(search->committed[axis], gap);
+			search->numberOfLines++;
+			SearchNode(search, depth + 1);
+			search->numberOfLines--;
+			ClearGap(search->committed[axis], gap);
+		}
+		SetGap(search->excluded[axis], gap);
+		index++;
+	}
+	index = first;
+	while (index < last)
+	{
+		ClearGap(search->excluded[search->branches[index] & 1], search->branches[index] >> 2);
+		index++;
+	}
+	search->branchTop = first;
+}
+
+void InitializeSearch(ExactSearch *search, ExactShared *shared)
+{
+	size_t n = (size_t)shared->solver->myNumberOfPoints;
+	size_t words = (size_t)shared->words;
+	memset(search, 0, sizeof(ExactSearch));
+	search->shared = shared;
+	search->committed[X] = (ConnectionWord *)AllocateClearedStorage(words, sizeof(ConnectionWord));
+	search->committed[Y] = (ConnectionWord *)AllocateClearedStorage(words, sizeof(ConnectionWord));
+	search->excluded[X] = (ConnectionWord *)AllocateClearedStorage(words, sizeof(ConnectionWord));
+	search->excluded[Y] = (ConnectionWord *)AllocateClearedStorage(words, sizeof(ConnectionWord));
+	search->bandOfRank[X] = (int *)AllocateStorage(sizeof(int) * n);
+	search->bandOfRank[Y] = (int *)AllocateStorage(sizeof(int) * n);
+	search->availableBelow[X] = (int *)AllocateStorage(sizeof(int) * n);
+	search->availableBelow[Y] = (int *)AllocateStorage(sizeof(int) * n);
+	search->lastRank = (int *)AllocateStorage(sizeof(int) * n);
+	search->lastBand = (int *)AllocateStorage(sizeof(int) * n);
+	search->bandMark = (int *)AllocateClearedStorage(n, sizeof(int));
+	search->gapMark = (int *)AllocateClearedStorage(n, sizeof(int));
+	search->hasMate = (int *)AllocateStorage(sizeof(int) * n);
+	search->frontierDepth = -1;
+}
+
+void FreeSearch(ExactSearch *search)
+{
+	free(search->committed[X]);
+	free(search->committed[Y]);
+	free(search->excluded[X]);
+	free(search->excluded[Y]);
+	free(search->bandOfRank[X]);
+	free(search->bandOfRank[Y]);
+	free(search->availableBelow[X]);
+	free(search->availableBelow[Y]);
+	free(search->lastRank);
+	free(search->lastBand);
+	free(search->bandMark);
+	free(search->gapMark);
+	free(search->hasMate);
+	free(search->branches);
+}
+
+/* Search one subtree of the frontier with the search state of the worker */
+void SearchSubtree(void *context, int task, int worker)
+{
+	ExactShared *shared = (ExactShared *)context;
+	ExactSearch *search = &shared->searches[worker];
+	const ExactNode *node = &shared->frontier[task];
+	size_t size = sizeof(ConnectionWord) * (size_t)shared->words;
+	memcpy(search->committed[X], node->committed[X], size);
+	memcpy(search->committed[Y], node->committed[Y], size);
+	memcpy(search->excluded[X], node->excluded[X], size);
+	memcpy(search->excluded[Y], node->excluded[Y], size);
+	search->numberOfLines = node->numberOfLines;
+	SearchNode(search, 0);
+}
+
+/* Deepen the first levels of the tree until there are enough subtrees for the workers. Subtrees
+ * are only cut below nodes that survive the pruning, an empty frontier means the search is over
+ */
+void CollectFrontier(ExactShared *shared, ExactSearch *search)
+{
+	int depth = 1;
+	while (depth <= EXACT_MAX_FRONTIER_DEPTH)
+	{
+		while (shared->frontierSize > 0)
+		{
+			free(shared->frontier[--shared->frontierSize].committed[X]);
+		}
+		search->frontierDepth = depth;
+		SearchNode(search, 0);
+		if (shared->frontierSize == 0 || shared->frontierSize >= EXACT_SUBTREES_PER_WORKER * shared->numberOfWorkers)
+		{
+			break;
+		}
+		depth++;
+	}
+	search->frontierDepth = -1;
+}
+
+/* Find a solution with the fewest lines for the instance held by the solver and leave it in the
+ * solver. With a time limit the search stops at the deadline with the best solution so far
+ */
+void SolveExact(Solver *solver)
+{
+	double deadline = solver->myTimeLimit > 0 ? GetWallClock() + solver->myTimeLimit : 0;
+	int n = solver->myNumberOfPoints;
+
+	/* the greedy solution is the incumbent, the search only looks for better ones */
+	Solver run;
+	CopySolverSettings(&run, solver);
+	run.myExact = 0;
+	run.myTimeLimit = 0;
+	run.myNumberOfRestarts = 1;
+	run.myRestartWorkers = solver->myRestartWorkers;
+	run.myLocalSearch = 1;
+	run.myDeadline = deadline;
+	RunRestart(&run, solver, 0);
+
+	ExactShared shared;
+	memset(&shared, 0, sizeof(ExactShared));
+	shared.solver = &run;
+	shared.words = n / CONNECTION_WORD_BITS + 1;
+	shared.deadline = deadline;
+	shared.bestCommitted[X] = (ConnectionWord *)AllocateClearedStorage((size_t)shared.words, sizeof(ConnectionWord));
+	shared.bestCommitted[Y] = (ConnectionWord *)AllocateClearedStorage((size_t)shared.words, sizeof(ConnectionWord));
+	pthread_mutex_init(&shared.lock, NULL);
+
+	RestartResult best;
+	best.lines = (int *)AllocateStorage(sizeof(int) * 2 * (size_t)(n > 0 ? n : 1));
+	best.restart = -1;
+	best.numberOfLines = 0;
+	if (!run.myRemainingConnections)
+	{
+		KeepBestSolution(&run, 0, &best);
+	}
+	else
+	{
+		/* cut short by the deadline, fall back to the vertical lines between consecutive points */
+		while (best.numberOfLines < n - 1)
+		{
+			best.lines[best.numberOfLines] = 2 * best.numberOfLines + X;
+			best.numberOfLines++;
+		}
+	}
+	shared.bestNumberOfLines = best.numberOfLines;
+	int index = 0;
+	while (index < best.numberOfLines)
+	{
+		SetGap(shared.bestCommitted[best.lines[index] % 2], best.lines[index] / 2);
+		index++;
+	}
+
+	shared.numberOfWorkers = solver->myRestartWorkers < 1 ? GetNumberOfCores() : solver->myRestartWorkers;
+	shared.searches = (ExactSearch *)AllocateStorage(sizeof(ExactSearch) * (size_t)shared.numberOfWorkers);
+	index = 0;
+	while (index < shared.numberOfWorkers)
+	{
+		InitializeSearch(&shared.searches[index], &shared);
+		index++;
+	}
+
+	/* a solution meeting the lower bound needs no search */
+	if (shared.bestNumberOfLines > run.myBounds.best)
+	{
+		CollectFrontier(&shared, &shared.searches[0]);
+		int numberOfWorkers = shared.numberOfWorkers < shared.frontierSize ? shared.numberOfWorkers : shared.frontierSize;
+		if (numberOfWorkers > 0)
+		{
+			int *tasks = (int *)AllocateStorage(sizeof(int) * (size_t)shared.frontierSize);
+			index = 0;
+			while (index < shared.frontierSize)
+			{
+				tasks[index] = index;
+				index++;
+			}
+			RunWorkPool(numberOfWorkers, tasks, shared.frontierSize, &SearchSubtree, &shared);
+			free(tasks);
+		}
+	}
+
+	best.numberOfLines = 0;
+	int axis = X;
+	while (axis <= Y)
+	{
+		int gap = 0;
+		while (gap < n - 1)
+		{
+			if (IsGapSet(shared.bestCommitted[axis], gap))
+			{
+				best.lines[best.numberOfLines++] = 2 * gap + axis;
+			}
+			gap++;
+		}
+		axis++;
+	}
+	AdoptSolution(solver, &best);
+	solver->myIsTimedOut = shared.isTimedOut;
+	solver->myIsFinished = !shared.isTimedOut;
+	solver->myNumberOfNodes = 0;
+
+	index = 0;
+	while (index < shared.numberOfWorkers)
+	{
+		solver->myNumberOfNodes += shared.searches[index].numberOfNodes;
+		FreeSearch(&shared.searches[index]);
+		index++;
+	}
+	while (shared.frontierSize > 0)
+	{
+		free(shared.frontier[--shared.frontierSize].committed[X]);
+	}
+	free(shared.frontier);
+	free(shared.searches);
+	free(shared.bestCommitted[X]);
+	free(shared.bestCommitted[Y]);
+	pthread_mutex_destroy(&shared.lock);
+	free(best.lines);
+	FreeSolver(&run);
+}
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef EXACT_SOLVER_H
+#define  EXACT_SOLVER_H
+
+/* Includes */
+#include <pthread.h>
+#include "SeparatingLines.h"
+#include "MultiStart.h"
+
+/* Definitions */
+#define	EXACT_REPORT "Exact %s: %d lines, %s after %lld nodes\n"
+
+/* The search is split into at least this many subtrees per worker */
+#define	EXACT_SUBTREES_PER_WORKER	8
+#define	EXACT_MAX_FRONTIER_DEPTH	6
+
+/* Nodes between two looks at the clock */
+#define	EXACT_DEADLINE_NODES	1024
+
+/* Type Definitions */
+
+/* Two points sharing a cell, their ranks along each axis and the number of available gaps between them */
+typedef struct exactPair
+{
+	int lowRank[2];
+	int highRank[2];
+	int coverage;
+} ExactPair;
+
+/* A subtree of the search: the gaps committed and the gaps excluded on each axis */
+typedef struct exactNode
+{
+	ConnectionWord *committed[2];
+	ConnectionWord *excluded[2];
+	int numberOfLines;
+} ExactNode;
+
+typedef struct exactShared ExactShared;
+
+/* Search state of one worker */
+typedef struct exactSearch
+{
+	ExactShared *shared;
+	ConnectionWord *committed[2];
+	ConnectionWord *excluded[2];
+	int numberOfLines;
+	long long numberOfNodes;
+
+	/* Band of every rank along each axis, available gaps below every rank of each axis */
+	int *bandOfRank[2];
+	int *availableBelow[2];
+
+	/* Last point seen in every band of the scan, valid when the mark equals the epoch */
+	int *lastRank;
+	int *lastBand;
+	int *bandMark;
+	int *gapMark;
+	int epoch;
+
+	/* Whether every point shares its cell with another one, by x rank */
+	int *hasMate;
+
+	/* Stack of the covering gaps of the pairs branched on, as 4 * gap + 2 * isSkipped + axis */
+	int *branches;
+	int branchCapacity;
+	int branchTop;
+
+	/* Collects the frontier instead of searching below the given depth */
+	int frontierDepth;
+} ExactSearch;
+
+struct exactShared
+{
+	Solver *solver;
+	int words;
+	int numberOfWorkers;
+	double deadline;
+	int isTimedOut;
+
+	/* Best solution so far, the greedy one to start with */
+	int bestNumberOfLines;
+	ConnectionWord *bestCommitted[2];
+	pthread_mutex_t lock;
+
+	ExactNode *frontier;
+	int frontierSize;
+	int frontierCapacity;
+	ExactSearch *searches;
+};
+
+/* Functions */
+void SolveExact(Solver *solver);
+
+#endif
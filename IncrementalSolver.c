@@ -0,0 +1,532 @@
+/* Incremental solver. Keeps a solution valid while points come and go, without
+* solving the instance again. The lines of each axis are kept sorted by their
+* doubled coordinate, with the points of every slab between two consecutive lines,
+* so the cell of a point is found by two binary searches and the points sharing it
+* by scanning the smaller of its slab and its band. An inserted point sharing its
+* cell gets a single new line between it and the other point, half a unit away
+* from it, which splits one slab. Only the lines next to the change can become
+* redundant: the neighbours of the new line and the walls of the point's cell
+* after an insertion, the walls of the point's cell after a deletion. A line is
+* redundant when no band holds points on both of its sides, which is checked over
+* the two slabs it separates. Every update thus costs the size of the slabs and
+* bands it touches, plus O(log n) for the searches.
+*/
+
+#include <limits.h>
+#include "IncrementalSolver.h"
+#include "SolutionVerifier.h"
+
+int SortByCoordinate(const void *ptr1, const void *ptr2)
+{
+	long long coordinate1 = *(const long long *)ptr1;
+	long long coordinate2 = *(const long long *)ptr2;
+	return (coordinate1 < coordinate2 ? -1 : (coordinate1 > coordinate2));
+}
+
+int GetCoordinate(const IncrementalSolver *incremental, int id, int axis)
+{
+	return (incremental->values[axis][id]);
+}
+
+/* Get the slab of the axis holding the doubled coordinate, i.e. the number of lines below it */
+int GetSlab(const IncrementalSolver *incremental, int axis, long long doubled)
+{
+	int low = 0;
+	int high = incremental->numberOfLines[axis];
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+		if (incremental->lines[axis][middle] < doubled)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return (low);
+}
+
+int GetPointSlab(const IncrementalSolver *incremental, int id, int axis)
+{
+	return (GetSlab(incremental, axis, 2 * (long long)GetCoordinate(incremental, id, axis)));
+}
+
+void AddToList(PointList *list, int id)
+{
+	if (list->count == list->capacity)
+	{
+		list->capacity = list->capacity > 0 ? 2 * list->capacity : 8;
+		list->ids = (int *)ResizeStorage(list->ids, sizeof(int) * (size_t)list->capacity);
+	}
+	list->ids[list->count++] = id;
+}
+
+void RemoveFromList(PointList *list, int id)
+{
+	int index = 0;
+	while (index < list->count && list->ids[index] != id)
+	{
+		index++;
+	}
+	if (index < list->count)
+	{
+		list->ids[index] = list->ids[--list->count];
+	}
+}
+
+/* Make room for one more line, and its slab, on the axis */
+void GrowLines(IncrementalSolver *incremental, int axis)
+{
+	if (incremental->numberOfLines[axis] < incremental->lineCapacity[axis])
+	{
+		return;
+	}
+	int capacity = incremental->lineCapacity[axis] > 0 ? 2 * incremental->lineCapacity[axis] : 16;
+	int numberOfLists = incremental->lineCapacity[axis] > 0 ? incremental->lineCapacity[axis] + 1 : 0;
+	incremental->lines[axis] = (long long *)ResizeStorage(incremental->lines[axis], sizeof(long long) * (size_t)capacity);
+	incremental->slabs[axis] = (PointList *)ResizeStorage(incremental->slabs[axis], sizeof(PointList) * (size_t)(capacity + 1));
+	memset(&incremental->slabs[axis][numberOfLists], 0, sizeof(PointList) * (size_t)(capacity + 1 - numberOfLists));
+	incremental->lineCapacity[axis] = capacity;
+}
+
+/* Add a line at the doubled coordinate, moving the points above it to a new slab */
+void InsertIncrementalLine(IncrementalSolver *incremental, int axis, long long doubled)
+{
+	GrowLines(incremental, axis);
+	int slab = GetSlab(incremental, axis, doubled);
+	int numberOfLines = incremental->numberOfLines[axis];
+	PointList *slabs = incremental->slabs[axis];
+
+	/* the spare list past the last slab is empty and becomes the new one */
+	PointList upper = slabs[numberOfLines + 1];
+	memmove(&incremental->lines[axis][slab + 1], &incremental->lines[axis][slab], sizeof(long long) * (size_t)(numberOfLines - slab));
+	memmove(&slabs[slab + 2], &slabs[slab + 1], sizeof(PointList) * (size_t)(numberOfLines - slab));
+	incremental->lines[axis][slab] = doubled;
+	incremental->numberOfLines[axis]++;
+	slabs[slab + 1] = upper;
+
+	PointList *lower = &slabs[slab];
+	int index = 0;
+	while (index < lower->count)
+	{
+		int id = lower->ids[index];
+		if (2 * (long long)GetCoordinate(incremental, id, axis) > doubled)
+		{
+			AddToList(&slabs[slab + 1], id);
+			lower->ids[index] = lower->ids[--lower->count];
+			continue;
+		}
+		index++;
+	}
+}
+
+/* Remove the line of the given index, merging the two slabs around it */
+void RemoveIncrementalLine(IncrementalSolver *incremental, int axis, int line)
+{
+	int numberOfLines = incremental->numberOfLines[axis];
+	PointList *slabs = incremental->slabs[axis];
+	PointList upper = slabs[line + 1];
+	int index = 0;
+	while (index < upper.count)
+	{
+		AddToList(&slabs[line], upper.ids[index]);
+		index++;
+	}
+	memmove(&incremental->lines[axis][line], &incremental->lines[axis][line + 1], sizeof(long long) * (size_t)(numberOfLines - line - 1));
+	memmove(&slabs[line + 1], &slabs[line + 2], sizeof(PointList) * (size_t)(numberOfLines - line - 1));
+
+	/* keep the emptied list as the spare one past the last slab */
+	upper.count = 0;
+	slabs[numberOfLines] = upper;
+	incremental->numberOfLines[axis]--;
+}
+
+/* Whether no band of the other axis holds points on both sides of the line */
+int IsIncrementalLineRedundant(IncrementalSolver *incremental, int axis, int line)
+{
+	int other = axis == X ? Y : X;
+	int numberOfBands = incremental->numberOfLines[other] + 1;
+	if (numberOfBands > incremental->slabMarkCapacity || incremental->epoch == INT_MAX)
+	{
+		free(incremental->slabMark);
+		incremental->slabMarkCapacity = 2 * numberOfBands;
+		incremental->slabMark = (int *)AllocateClearedStorage((size_t)incremental->slabMarkCapacity, sizeof(int));
+		incremental->epoch = 0;
+	}
+	incremental->epoch++;
+
+	int side = 0;
+	while (side < 2)
+	{
+		const PointList *slab = &incremental->slabs[axis][line + side];
+		int index = 0;
+		while (index < slab->count)
+		{
+			int band = GetPointSlab(incremental, slab->ids[index], other);
+			if (incremental->slabMark[band] == incremental->epoch)
+			{
+				return (0);
+			}
+			incremental->slabMark[band] = incremental->epoch;
+			index++;
+		}
+		side++;
+	}
+	return (1);
+}
+
+int RemoveIfRedundant(IncrementalSolver *incremental, int axis, int line)
+{
+	if (line < 0 || line >= incremental->numberOfLines[axis] || !IsIncrementalLineRedundant(incremental, axis, line))
+	{
+		return (0);
+	}
+	RemoveIncrementalLine(incremental, axis, line);
+	return (1);
+}
+
+/* Try to remove both lines of the axis around the point */
+void RemoveCellWalls(IncrementalSolver *incremental, int axis, int id)
+{
+	int slab = GetPointSlab(incremental, id, axis);
+	RemoveIfRedundant(incremental, axis, slab);
+	RemoveIfRedundant(incremental, axis, slab - 1);
+}
+
+/* Get the other point of the cell of the point, -1 if it is alone */
+int FindCellmate(const IncrementalSolver *incremental, int id)
+{
+	int slab = GetPointSlab(incremental, id, X);
+	int band = GetPointSlab(incremental, id, Y);
+	const PointList *list = &incremental->slabs[X][slab];
+	int axis = Y;
+	int target = band;
+	if (incremental->slabs[Y][band].count < list->count)
+	{
+		list = &incremental->slabs[Y][band];
+		axis = X;
+		target = slab;
+	}
+	int index = 0;
+	while (index < list->count)
+	{
+		int other = list->ids[index];
+		if (other != id && GetPointSlab(incremental, other, axis) == target)
+		{
+			return (other);
+		}
+		index++;
+	}
+	return (-1);
+}
+
+/* A line through the coordinate of a new point moves half a unit below it, where no point lies.
+ * When a line is there already the two would be the same, so the line is dropped instead
+ */
+void ClearLineAt(IncrementalSolver *incremental, int axis, int coordinate)
+{
+	long long doubled = 2 * (long long)coordinate;
+	int line = GetSlab(incremental, axis, doubled);
+	if (line < incremental->numberOfLines[axis] && incremental->lines[axis][line] == doubled)
+	{
+		if (line > 0 && incremental->lines[axis][line - 1] == doubled - 1)
+		{
+			RemoveIncrementalLine(incremental, axis, line);
+		}
+		else
+		{
+			incremental->lines[axis][line] = doubled - 1;
+		}
+	}
+}
+
+/* Build the live structure from the solution held by a solved solver */
+void InitializeIncremental(IncrementalSolver *incremental, Solver *solver)
+{
+	memset(incremental, 0, sizeof(IncrementalSolver));
+	int n = solver->myNumberOfPoints;
+	incremental->pointCapacity = n > 16 ? n : 16;
+	incremental->values[X] = (int *)AllocateStorage(sizeof(int) * (size_t)incremental->pointCapacity);
+	incremental->values[Y] = (int *)AllocateStorage(sizeof(int) * (size_t)incremental->pointCapacity);
+	memcpy(incremental->values[X], solver->myValues[X], sizeof(int) * (size_t)n);
+	memcpy(incremental->values[Y], solver->myValues[Y], sizeof(int) * (size_t)n);
+	incremental->numberOfPoints = n;
+
+	int index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[index];
+		if (l->isCommitted)
+		{
+			GrowLines(incremental, l->lineAxis);
+			incremental->lines[l->lineAxis][incremental->numberOfLines[l->lineAxis]++] = GetDoubledIntersectionValue(solver, l);
+		}
+		index++;
+	}
+	int axis = X;
+	while (axis <= Y)
+	{
+		GrowLines(incremental, axis);
+		qsort(incremental->lines[axis], (size_t)incremental->numberOfLines[axis], sizeof(long long), &SortByCoordinate);
+		index = 0;
+		while (index < n)
+		{
+			AddToList(&incremental->slabs[axis][GetPointSlab(incremental, index, axis)], index);
+			index++;
+		}
+		axis++;
+	}
+}
+
+void FreeIncremental(IncrementalSolver *incremental)
+{
+	int axis = X;
+	while (axis <= Y)
+	{
+		int slab = 0;
+		while (slab <= incremental->lineCapacity[axis])
+		{
+			free(incremental->slabs[axis][slab].ids);
+			slab++;
+		}
+		free(incremental->slabs[axis]);
+		free(incremental->lines[axis]);
+		axis++;
+	}
+	free(incremental->values[X]);
+	free(incremental->values[Y]);
+	free(incremental->slabMark);
+}
+
+/* Add a point and repair the solution around it, returns its id or -1 if the point already exists */
+int InsertIncrementalPoint(IncrementalSolver *incremental, int xValue, int yValue)
+{
+	if (incremental->numberOfPoints == incremental->pointCapacity)
+	{
+		incremental->pointCapacity *= 2;
+		incremental->values[X] = (int *)ResizeStorage(incremental->values[X], sizeof(int) * (size_t)incremental->pointCapacity);
+		incremental->values[Y] = (int *)ResizeStorage(incremental->values[Y], sizeof(int) * (size_t)incremental->pointCapacity);
+	}
+	int id = incremental->numberOfPoints;
+	incremental->values[X][id] = xValue;
+	incremental->values[Y][id] = yValue;
+
+	int mate = FindCellmate(incremental, id);
+	if (mate >= 0 && incremental->values[X][mate] == xValue && incremental->values[Y][mate] == yValue)
+	{
+		return (-1);
+	}
+	incremental->numberOfPoints++;
+	ClearLineAt(incremental, X, xValue);
+	ClearLineAt(incremental, Y, yValue);
+	AddToList(&incremental->slabs[X][GetPointSlab(incremental, id, X)], id);
+	AddToList(&incremental->slabs[Y][GetPointSlab(incremental, id, Y)], id);
+	mate = FindCellmate(incremental, id);
+	if (mate < 0)
+	{
+		return (id);
+	}
+
+	/* split the more crowded of the point's slab and band, unless the two points are aligned */
+	int axis;
+	if (incremental->values[X][mate] == xValue)
+	{
+		axis = Y;
+	}
+	else if (incremental->values[Y][mate] == yValue)
+	{
+		axis = X;
+	}
+	else
+	{
+		axis = incremental->slabs[X][GetPointSlab(incremental, id, X)].count >= incremental->slabs[Y][GetPointSlab(incremental, id, Y)].count ? X : Y;
+	}
+	int other = axis == X ? Y : X;
+	int coordinate = GetCoordinate(incremental, id, axis);
+	long long doubled = 2 * (long long)coordinate + (coordinate < GetCoordinate(incremental, mate, axis) ? 1 : -1);
+	InsertIncrementalLine(incremental, axis, doubled);
+
+	int line = GetSlab(incremental, axis, doubled);
+	RemoveIfRedundant(incremental, axis, line + 1);
+	RemoveIfRedundant(incremental, axis, line - 1);
+	RemoveCellWalls(incremental, other, id);
+	return (id);
+}
+
+/* Remove the point at the given coordinates and the lines it alone needed, returns 0 if there is no such point */
+int DeleteIncrementalPoint(IncrementalSolver *incremental, int xValue, int yValue)
+{
+	const PointList *slab = &incremental->slabs[X][GetSlab(incremental, X, 2 * (long long)xValue)];
+	int index = 0;
+	while (index < slab->count && (incremental->values[X][slab->ids[index]] != xValue ||
+		incremental->values[Y][slab->ids[index]] != yValue))
+	{
+		index++;
+	}
+	if (index == slab->count)
+	{
+		return (0);
+	}
+	int id = slab->ids[index];
+	RemoveFromList(&incremental->slabs[X][GetPointSlab(incremental, id, X)], id);
+	RemoveFromList(&incremental->slabs[Y][GetPointSlab(incremental, id, Y)], id);
+	RemoveCellWalls(incremental, X, id);
+	RemoveCellWalls(incremental, Y, id);
+	return (1);
+}
+
+int CountIncrementalLines(const IncrementalSolver *incremental)
+{
+	return (incremental->numberOfLines[X] + incremental->numberOfLines[Y]);
+}
+
+/* Write the lines in the text format of WriteSolutionFile */
+void WriteIncrementalSolution(const IncrementalSolver *incremental, const char *solutionName)
+{
+	FILE *out = fopen(solutionName, "w");
+	if (out == NULL)
+	{
+		return;
+	}
+	fprintf(out, "%d\n", CountIncrementalLines(incremental));
+	int axis = X;
+	while (axis <= Y)
+	{
+		int line = 0;
+		while (line < incremental->numberOfLines[axis])
+		{
+			(void)fprintf(out, "%s %f\n", axis == X ? "v" : "h", (double)incremental->lines[axis][line] / 2);
+			line++;
+		}
+		axis++;
+	}
+	fclose(out);
+}
+
+/* Check the lines against the points left after the updates and report it under the name of the instance */
+void VerifyIncrementalSolution(const IncrementalSolver *incremental, const char *fileName, int numberOfWorkers)
+{
+	size_t capacity = (size_t)incremental->numberOfPoints + 1;
+	int *xValues = (int *)AllocateStorage(sizeof(int) * capacity);
+	int *yValues = (int *)AllocateStorage(sizeof(int) * capacity);
+	int numberOfPoints = 0;
+	int slab = 0;
+	while (slab <= incremental->numberOfLines[X])
+	{
+		const PointList *list = &incremental->slabs[X][slab];
+		int index = 0;
+		while (index < list->count)
+		{
+			xValues[numberOfPoints] = incremental->values[X][list->ids[index]];
+			yValues[numberOfPoints] = incremental->values[Y][list->ids[index]];
+			numberOfPoints++;
+			index++;
+		}
+		slab++;
+	}
+
+	SolutionLines lines;
+	int axis = X;
+	while (axis <= Y)
+	{
+		lines.numberOfLines[axis] = incremental->numberOfLines[axis];
+		lines.lines[axis] = (int64_t *)AllocateStorage(sizeof(int64_t) * (size_t)(incremental->numberOfLines[axis] + 1));
+		int line = 0;
+		while (line < incremental->numberOfLines[axis])
+		{
+			lines.lines[axis][line] = incremental->lines[axis][line];
+			line++;
+		}
+		axis++;
+	}
+
+	Verification result;
+	(void)VerifyLines(xValues, yValues, numberOfPoints, &lines, numberOfWorkers, &result);
+	ReportVerification(fileName, xValues, yValues, &result);
+	FreeSolutionLines(&lines);
+	free(yValues);
+	free(xValues);
+}
+
+/* Apply an update file, one "+ x y" insertion or "- x y" deletion per line */
+int ApplyUpdateFile(IncrementalSolver *incremental, const char *fileName, UpdateCounts *counts)
+{
+	FILE *in = fopen(fileName, "r");
+	if (in == NULL)
+	{
+		return (FILE_NOT_FOUND);
+	}
+	counts->inserted = 0;
+	counts->deleted = 0;
+	counts->rejected = 0;
+	char operation;
+	int xValue;
+	int yValue;
+	int scanned;
+	while ((scanned = fscanf(in, " %c %d %d", &operation, &xValue, &yValue)) == 3)
+	{
+		if (operation == '+')
+		{
+			if (InsertIncrementalPoint(incremental, xValue, yValue) >= 0)
+			{
+				counts->inserted++;
+			}
+			else
+			{
+				counts->rejected++;
+			}
+		}
+		else if (operation == '-')
+		{
+			if (DeleteIncrementalPoint(incremental, xValue, yValue))
+			{
+				counts->deleted++;
+			}
+			else
+			{
+				counts->rejected++;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+	fclose(in);
+	return (scanned == EOF ? SUCCESS : BAD_FORMAT);
+}
+
+/* Apply the update file of the options to the solution of the instance and write the result
+ * in place of the solution of the instance
+ */
+void SolveUpdates(Solver *solver, char *fileName, const Options *options)
+{
+	IncrementalSolver incremental;
+	UpdateCounts counts;
+	InitializeIncremental(&incremental, solver);
+	double start = GetWallClock();
+	int fileStatus = ApplyUpdateFile(&incremental, options->updateFile, &counts);
+	double elapsed = GetWallClock() - start;
+	if (fileStatus == FILE_NOT_FOUND)
+	{
+		(void)fprintf(stderr, NO_FILE_ERR, options->updateFile);
+		exit(0);
+	}
+	if (fileStatus == BAD_FORMAT)
+	{
+		(void)fprintf(stderr, UPDATE_FORMAT_ERR, options->updateFile);
+	}
+
+	char solutionName[255];
+	GetSolutionFileName(fileName, solutionName, "");
+	WriteIncrementalSolution(&incremental, solutionName);
+	printf(UPDATE_REPORT, fileName, counts.inserted, counts.deleted, counts.rejected,
+		CountIncrementalLines(&incremental), elapsed * 1000);
+	if (options->isVerifying)
+	{
+		VerifyIncrementalSolution(&incremental, fileName, solver->myRestartWorkers);
+	}
+	FreeIncremental(&incremental);
+}
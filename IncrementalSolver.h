@@ -0,0 +1,66 @@
+#pragma once
+#ifndef INCREMENTAL_SOLVER_H
+#define  INCREMENTAL_SOLVER_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	UPDATE_REPORT "Updates %s: %d inserted, %d deleted, %d rejected, %d lines in %.3f ms\n"
+#define	UPDATE_FORMAT_ERR "The update file %s has a bad line, expected + x y or - x y\n"
+#define	UPDATE_MODE_ERR "Updates are applied to single files, without -j or -b\n"
+
+/* Type Definitions */
+
+/* Ids of the points of one slab (vertical lines) or band (horizontal lines) */
+typedef struct pointList
+{
+	int *ids;
+	int count;
+	int capacity;
+} PointList;
+
+/* A solution kept live under point insertions and deletions. The lines of each axis
+ * are stored sorted by their doubled coordinate, and the points of every slab between
+ * two of them, so a point's cell is the pair of its slab and its band
+ */
+typedef struct incrementalSolver
+{
+	/* Coordinates of every point by id along each axis */
+	int *values[2];
+	int numberOfPoints;
+	int pointCapacity;
+
+	long long *lines[2];
+	int numberOfLines[2];
+	int lineCapacity[2];
+
+	/* numberOfLines + 1 lists per axis */
+	PointList *slabs[2];
+
+	/* Per slab marks of the redundancy test, valid when equal to the epoch */
+	int *slabMark;
+	int slabMarkCapacity;
+	int epoch;
+} IncrementalSolver;
+
+/* Outcome of an update file */
+typedef struct updateCounts
+{
+	int inserted;
+	int deleted;
+	int rejected;
+} UpdateCounts;
+
+/* Functions */
+void InitializeIncremental(IncrementalSolver *incremental, Solver *solver);
+void FreeIncremental(IncrementalSolver *incremental);
+int InsertIncrementalPoint(IncrementalSolver *incremental, int xValue, int yValue);
+int DeleteIncrementalPoint(IncrementalSolver *incremental, int xValue, int yValue);
+int CountIncrementalLines(const IncrementalSolver *incremental);
+void WriteIncrementalSolution(const IncrementalSolver *incremental, const char *solutionName);
+void VerifyIncrementalSolution(const IncrementalSolver *incremental, const char *fileName, int numberOfWorkers);
+int ApplyUpdateFile(IncrementalSolver *incremental, const char *fileName, UpdateCounts *counts);
+void SolveUpdates(Solver *solver, char *fileName, const Options *options);
+
+#endif
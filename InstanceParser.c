@@ -0,0 +1,207 @@
+/* Instance loading. The file is memory mapped and scanned in place by a hand
+* rolled integer scanner that writes the coordinates straight into the solver
+* storage, instead of going through fscanf for every point. Anything but
+* whitespace after the announced number of points is reported as a malformed
+* instance.
+*/
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "InstanceParser.h"
+#include "BinaryFormat.h"
+
+/* Map the file into memory, or read it when it cannot be mapped (pipes, special files) */
+int OpenInstanceText(InstanceText *text, char *fileName)
+{
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+	{
+		return (FILE_NOT_FOUND);
+	}
+
+	struct stat info;
+	text->isMapped = 0;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+	{
+		if (info.st_size == 0)
+		{
+			close(fd);
+			text->begin = text->end = NULL;
+			return (SUCCESS);
+		}
+		void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED)
+		{
+			(void)madvise(mapped, (size_t)info.st_size, MADV_SEQUENTIAL);
+			close(fd);
+			text->begin = (const char *)mapped;
+			text->end = text->begin + info.st_size;
+			text->isMapped = 1;
+			return (SUCCESS);
+		}
+	}
+
+	size_t capacity = 1 << 16;
+	size_t length = 0;
+	char *buffer = (char *)malloc(capacity);
+	ssize_t got;
+	while (buffer != NULL && (got = read(fd, buffer + length, capacity - length)) > 0)
+	{
+		length += (size_t)got;
+		if (length == capacity)
+		{
+			capacity *= 2;
+			char *grown = (char *)realloc(buffer, capacity);
+			if (grown == NULL)
+			{
+				free(buffer);
+			}
+			buffer = grown;
+		}
+	}
+	close(fd);
+	if (buffer == NULL)
+	{
+		return (FILE_NOT_FOUND);
+	}
+	text->begin = buffer;
+	text->end = buffer + length;
+	return (SUCCESS);
+}
+
+void CloseInstanceText(InstanceText *text)
+{
+	if (text->isMapped)
+	{
+		munmap((void *)text->begin, (size_t)(text->end - text->begin));
+	}
+	else
+	{
+		free((void *)text->begin);
+	}
+}
+
+/* Skip whitespace and scan one decimal integer into value.
+ * Returns 0 when the text ends or does not start with an integer that fits an int
+ */
+int ScanInteger(const char **cursor, const char *end, int *value)
+{
+	const char *c = *cursor;
+	while (c < end && IS_BLANK(*c))
+	{
+		c++;
+	}
+
+	int negative = 0;
+	if (c < end && (*c == '-' || *c == '+'))
+	{
+		negative = *c == '-';
+		c++;
+	}
+	if (c >= end || (unsigned)(*c - '0') > 9)
+	{
+		return (0);
+	}
+
+	/* accumulate negatively so that INT_MIN is representable */
+	long long number = 0;
+	while (c < end && (unsigned)(*c - '0') <= 9)
+	{
+		number = number * 10 - (*c - '0');
+		if (number < INT_MIN)
+		{
+			return (0);
+		}
+		c++;
+	}
+	if (!negative)
+	{
+		number = -number;
+		if (number > INT_MAX)
+		{
+			return (0);
+		}
+	}
+	*value = (int)number;
+	*cursor = c;
+	return (1);
+}
+
+/* Parse the instance text into the solver storage */
+int ParseInstance(Solver *solver, const char *text, size_t length)
+{
+	const char *cursor = text;
+	const char *end = text + length;
+
+	/* read number of points from the text */
+	int numberOfPoints;
+	if (!ScanInteger(&cursor, end, &numberOfPoints) || numberOfPoints <= 0)
+	{
+		return (NO_POINTS);
+	}
+
+	/* a header announcing more points than the text can hold is rejected before allocating */
+	if ((size_t)numberOfPoints > (size_t)(end - cursor) / MIN_POINT_BYTES + 1)
+	{
+		return (POINTS_MORE_LESS);
+	}
+
+	/* size the solver storage from the header */
+	solver->myNumberOfPoints = numberOfPoints;
+	AllocateSolverStorage(solver, numberOfPoints);
+
+	int *xValues = solver->myValues[X];
+	int *yValues = solver->myValues[Y];
+	int i = 0;
+	while (i < numberOfPoints)
+	{
+		if (!ScanInteger(&cursor, end, &xValues[i]) || !ScanInteger(&cursor, end, &yValues[i]))
+		{
+			return (POINTS_MORE_LESS);
+		}
+		i++;
+	}
+
+	/* nothing but whitespace may follow the points */
+	while (cursor < end)
+	{
+		if (!IS_BLANK(*cursor))
+		{
+			return (POINTS_MORE_LESS);
+		}
+		cursor++;
+	}
+
+	return (SUCCESS);
+}
+
+/* Read input data from the file and validate, text and binary point sets are both accepted */
+int ReadInputFile(Solver *solver, char* fileName)
+{
+	double start = GetWallClock();
+	InstanceText text;
+	int fileStatus = OpenInstanceText(&text, fileName);
+	if (fileStatus != SUCCESS)
+	{
+		return (fileStatus);
+	}
+
+	size_t length = (size_t)(text.end - text.begin);
+	if (IsBinaryFormat(text.begin, length, POINT_SET_MAGIC))
+	{
+		fileStatus = ParseBinaryInstance(solver, text.begin, length);
+	}
+	else
+	{
+		fileStatus = ParseInstance(solver, text.begin, length);
+	}
+	CloseInstanceText(&text);
+
+	solver->myInputBytes = length;
+	solver->myParseTime = GetWallClock() - start;
+	STATS_ADD(solver, phaseTime[PARSE_PHASE], solver->myParseTime);
+	return (fileStatus);
+}
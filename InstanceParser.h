@@ -0,0 +1,33 @@
+#pragma once
+#ifndef INSTANCE_PARSER_H
+#define  INSTANCE_PARSER_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	PARSE_THROUGHPUT "Parsed %s: %.2f MB in %.3f ms, %.1f MB/s\n"
+
+/* Whitespace as accepted by fscanf: space, \t, \n, \v, \f and \r */
+#define	IS_BLANK(c)	((c) == ' ' || (unsigned)((c) - '\t') <= 4)
+
+/* Smallest text a point can take, one digit per coordinate and two separators */
+#define	MIN_POINT_BYTES	4
+
+/* Type Definitions */
+
+/* The whole instance file, mapped or read into memory */
+typedef struct instanceText
+{
+	const char *begin;
+	const char *end;
+	int isMapped;
+} InstanceText;
+
+/* Functions */
+int OpenInstanceText(InstanceText *text, char *fileName);
+void CloseInstanceText(InstanceText *text);
+int ScanInteger(const char **cursor, const char *end, int *value);
+int ParseInstance(Solver *solver, const char *text, size_t length);
+
+#endif
@@ -0,0 +1,289 @@
+/* Local optimization. A pass over one axis looks for two committed lines that a
+* single new line of the other axis can replace, the move of the Local
+* Optimization Procedure. After OptimizeSolution every line is needed, so removing
+* it merges its two slabs and some band of the other axis ends up with two points
+* in the merged slab. A line is a candidate only when this happens in exactly one
+* band, and two candidates can be replaced when they need the same band and their
+* rank ranges in it overlap: the new line goes into the overlap. Two adjacent lines
+* never qualify, the band would hold three points of the merged slab. Radix sorting
+* the candidates by band and range finds all the moves in O(n) per pass, and
+* the passes repeat with OptimizeSolution in between until no move is left.
+*/
+
+#include "LocalOptimization.h"
+#include "RadixSort.h"
+
+/* Sort the requirements by band and low rank. They are found in gap order and the radix sort
+ * is stable, so the gap breaks the ties
+ */
+void SortRequirements(LocalSearch *search, int numberOfRequirements)
+{
+	int index = 0;
+	while (index < numberOfRequirements)
+	{
+		const LineRequirement *requirement = &search->requirements[index];
+		search->sortKeys[index] = (uint64_t)requirement->band << 32 | (uint64_t)requirement->lowRank;
+		search->sortOrder[index] = index;
+		index++;
+	}
+	RadixSortKeys(search->sortKeys, search->sortOrder, search->sortKeyBuffer, search->sortOrderBuffer, (size_t)numberOfRequirements, 1);
+	index = 0;
+	while (index < numberOfRequirements)
+	{
+		search->sortedRequirements[index] = search->requirements[search->sortOrder[index]];
+		index++;
+	}
+	LineRequirement *swap = search->requirements;
+	search->requirements = search->sortedRequirements;
+	search->sortedRequirements = swap;
+}
+
+/* Drop the uncommitted lines from the list of committed lines */
+void CompactCommittedLines(Solver *solver)
+{
+	int kept = 0;
+	int index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		if (solver->myCommittedLines[index]->isCommitted)
+		{
+			solver->myCommittedLines[kept++] = solver->myCommittedLines[index];
+		}
+		index++;
+	}
+	solver->myNumberOfLines = kept;
+}
+
+/* Commit a line of the final solution. Unlike CommitLine it leaves the connections alone,
+ * they are no longer looked at once the greedy is done
+ */
+void PlaceLine(Solver *solver, Line *l)
+{
+	if (solver->myNumberOfLines == 2 * solver->myNumberOfPoints)
+	{
+		CompactCommittedLines(solver);
+	}
+	l->isCommitted = 1;
+	solver->myCommittedLines[solver->myNumberOfLines++] = l;
+	solver->myCommittedGaps[l->lineAxis][l->leftRank / CONNECTION_WORD_BITS] |= (ConnectionWord)1 << (l->leftRank % CONNECTION_WORD_BITS);
+}
+
+void RemoveLine(Solver *solver, Line *l)
+{
+	l->isCommitted = 0;
+	solver->myCommittedGaps[l->lineAxis][l->leftRank / CONNECTION_WORD_BITS] &= ~((ConnectionWord)1 << (l->leftRank % CONNECTION_WORD_BITS));
+}
+
+/* The neighbours of a removed line see their slabs grow, their requirements no longer hold */
+void TouchNeighbours(Solver *solver, LocalSearch *search, int axis, int gap)
+{
+	int previous = PreviousCommittedGap(solver, axis, gap);
+	int next = NextCommittedGap(solver, axis, gap);
+	if (previous >= 0)
+	{
+		search->isTouched[previous] = 1;
+	}
+	if (next < solver->myNumberOfPoints - 1)
+	{
+		search->isTouched[next] = 1;
+	}
+}
+
+/* Replace the lines of both requirements by one line of the other axis at the start of the overlap */
+void ReplaceLines(Solver *solver, LocalSearch *search, int axis, const LineRequirement *requirement1, const LineRequirement *requirement2)
+{
+	int other = axis == X ? Y : X;
+	int rank = requirement1->lowRank > requirement2->lowRank ? requirement1->lowRank : requirement2->lowRank;
+	RemoveLine(solver, search->lineOfGap[axis][requirement1->gap]);
+	RemoveLine(solver, search->lineOfGap[axis][requirement2->gap]);
+	TouchNeighbours(solver, search, axis, requirement1->gap);
+	TouchNeighbours(solver, search, axis, requirement2->gap);
+	PlaceLine(solver, search->lineOfGap[other][rank]);
+	STATS_ADD(solver, localMoves, 1);
+}
+
+/* Find the requirement of every committed line of the axis, returns the number of candidates */
+int FindRequirements(Solver *solver, LocalSearch *search, int axis)
+{
+	int other = axis == X ? Y : X;
+	const int *otherRanks = solver->myOtherRanks[axis];
+	int n = solver->myNumberOfPoints;
+
+	int rank = 0;
+	int band = 0;
+	while (rank < n)
+	{
+		search->bandOfRank[rank] = band;
+		if (rank < n - 1 && (solver->myCommittedGaps[other][rank / CONNECTION_WORD_BITS] >> (rank % CONNECTION_WORD_BITS) & 1))
+		{
+			band++;
+		}
+		rank++;
+	}
+
+	/* mark the bands of the left slab, then look for them in the right slab */
+	int numberOfRequirements = 0;
+	int previous = -1;
+	int gap = NextCommittedGap(solver, axis, -1);
+	while (gap < n - 1)
+	{
+		int next = NextCommittedGap(solver, axis, gap);
+		LineRequirement *requirement = &search->requirements[numberOfRequirements];
+		int collisions = 0;
+		search->isTouched[gap] = 0;
+		search->epoch++;
+		rank = previous + 1;
+		while (rank <= gap)
+		{
+			int otherRank = otherRanks[rank];
+			band = search->bandOfRank[otherRank];
+			search->bandMark[band] = search->epoch;
+			search->bandRank[band] = otherRank;
+			rank++;
+		}
+		while (rank <= next && collisions < 2)
+		{
+			int otherRank = otherRanks[rank];
+			band = search->bandOfRank[otherRank];
+			if (search->bandMark[band] == search->epoch)
+			{
+				int leftRank = search->bandRank[band];
+				requirement->band = band;
+				requirement->lowRank = leftRank < otherRank ? leftRank : otherRank;
+				requirement->highRank = (leftRank < otherRank ? otherRank : leftRank) - 1;
+				collisions++;
+			}
+			rank++;
+		}
+		if (collisions == 1)
+		{
+			requirement->gap = gap;
+			numberOfRequirements++;
+		}
+		previous = gap;
+		gap = next;
+	}
+	return (numberOfRequirements);
+}
+
+/* Apply the pair replacements of one axis, returns the number of moves. A move splits its band
+ * and grows the slabs of the neighbours of both lines, so the rest of that band and the
+ * neighbours wait for the next pass
+ */
+int ReplaceLinePairs(Solver *solver, LocalSearch *search, int axis)
+{
+	if (solver->myNumberOfPoints < 2)
+	{
+		return (0);
+	}
+	CompactCommittedLines(solver);
+	int numberOfRequirements = FindRequirements(solver, search, axis);
+	SortRequirements(search, numberOfRequirements);
+
+	int moves = 0;
+	int first = 0;
+	while (first < numberOfRequirements)
+	{
+		int last = first;
+		while (last < numberOfRequirements && search->requirements[last].band == search->requirements[first].band)
+		{
+			last++;
+		}
+
+		/* the three open candidates reaching highest, at most two of them are adjacent to the current one */
+		const LineRequirement *open[3] = { NULL, NULL, NULL };
+		int index = first;
+		while (index < last)
+		{
+			const LineRequirement *current = &search->requirements[index];
+			index++;
+			if (search->isTouched[current->gap])
+			{
+				continue;
+			}
+
+			const LineRequirement *partner = NULL;
+			int k = 0;
+			while (k < 3 && open[k] != NULL && open[k]->highRank >= current->lowRank)
+			{
+				int lower = open[k]->gap < current->gap ? open[k]->gap : current->gap;
+				int upper = open[k]->gap < current->gap ? current->gap : open[k]->gap;
+				if (NextCommittedGap(solver, axis, lower) != upper)
+				{
+					partner = open[k];
+					break;
+				}
+				k++;
+			}
+			if (partner != NULL)
+			{
+				ReplaceLines(solver, search, axis, partner, current);
+				moves++;
+				break;
+			}
+
+			k = 3;
+			while (k > 0 && (open[k - 1] == NULL || open[k - 1]->highRank < current->highRank))
+			{
+				if (k < 3)
+				{
+					open[k] = open[k - 1];
+				}
+				k--;
+			}
+			if (k < 3)
+			{
+				open[k] = current;
+			}
+		}
+		first = last;
+	}
+	return (moves);
+}
+
+/* Replace pairs of lines by single lines until no move is left, removing the lines each move
+ * makes redundant on the way
+ */
+void OptimizeLocally(Solver *solver)
+{
+	size_t n = (size_t)solver->myNumberOfPoints;
+	LocalSearch search;
+	search.lineOfGap[X] = (Line **)ArenaAlloc(&solver->myArena, sizeof(Line *) * n);
+	search.lineOfGap[Y] = (Line **)ArenaAlloc(&solver->myArena, sizeof(Line *) * n);
+	search.bandOfRank = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	search.bandRank = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	search.bandMark = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	search.isTouched = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	search.requirements = (LineRequirement *)ArenaAlloc(&solver->myArena, sizeof(LineRequirement) * n);
+	search.sortedRequirements = (LineRequirement *)ArenaAlloc(&solver->myArena, sizeof(LineRequirement) * n);
+	search.sortKeys = (uint64_t *)ArenaAlloc(&solver->myArena, sizeof(uint64_t) * n);
+	search.sortKeyBuffer = (uint64_t *)ArenaAlloc(&solver->myArena, sizeof(uint64_t) * n);
+	search.sortOrder = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	search.sortOrderBuffer = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	memset(search.bandMark, 0, sizeof(int) * n);
+	search.epoch = 0;
+
+	int index = 0;
+	while (index < solver->myNumberOfLinesInXAxis)
+	{
+		search.lineOfGap[X][solver->myXAxisLines[index].leftRank] = &solver->myXAxisLines[index];
+		index++;
+	}
+	index = 0;
+	while (index < solver->myNumberOfLinesInYAxis)
+	{
+		search.lineOfGap[Y][solver->myYAxisLines[index].leftRank] = &solver->myYAxisLines[index];
+		index++;
+	}
+
+	int moves;
+	do
+	{
+		moves = ReplaceLinePairs(solver, &search, X);
+		moves += ReplaceLinePairs(solver, &search, Y);
+		if (moves && !IsPastDeadline(solver))
+		{
+			OptimizeSolution(solver);
+		}
+	} while (moves && !IsPastDeadline(solver));
+}
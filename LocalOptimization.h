@@ -0,0 +1,55 @@
+#pragma once
+#ifndef LOCAL_OPTIMIZATION_H
+#define  LOCAL_OPTIMIZATION_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Type Definitions */
+
+/* What a committed line still separates. Once the line is removed exactly one band of the
+ * other axis holds two points of the merged slab, and a new line of the other axis between
+ * ranks lowRank and highRank + 1 separates them again
+ */
+typedef struct lineRequirement
+{
+	int band;
+	int lowRank;
+	int highRank;
+	int gap;
+} LineRequirement;
+
+/* Work storage of the pair replacement passes, sized once per instance */
+typedef struct localSearch
+{
+	/* Every candidate line by gap of each axis */
+	Line **lineOfGap[2];
+
+	/* Band of every rank of the other axis */
+	int *bandOfRank;
+
+	/* Rank of the other axis of the point of each band on the left of the line, valid when
+	 * the mark equals the epoch
+	 */
+	int *bandRank;
+	int *bandMark;
+	int epoch;
+
+	/* Lines that can no longer take part in a move of the current pass */
+	int *isTouched;
+
+	LineRequirement *requirements;
+
+	/* Radix keys of the requirements, their order and the requirements in that order */
+	LineRequirement *sortedRequirements;
+	uint64_t *sortKeys;
+	uint64_t *sortKeyBuffer;
+	int *sortOrder;
+	int *sortOrderBuffer;
+} LocalSearch;
+
+/* Functions */
+int ReplaceLinePairs(Solver *solver, LocalSearch *search, int axis);
+void OptimizeLocally(Solver *solver);
+
+#endif
@@ -0,0 +1,135 @@
+/* Lower bounds on the number of lines of any solution, reported next to every
+* solution so that the distance to the optimum is known. a vertical and b
+* horizontal lines make (a + 1)(b + 1) cells, which must hold n points, so at
+* least ceil(2 sqrt(n)) - 2 lines are needed. The points of a chain increasing
+* in both x and y are pairwise separated only by lines between consecutive
+* points of the chain, and every line lies between exactly one such consecutive
+* pair, so a chain of L points needs L - 1 lines; the same holds for a chain
+* decreasing in y. The longest chains are found in O(n log n) by patience sorting
+* the y ranks in x order. More generally, pairs of points such that no line
+* separates two of them need one line each. Points consecutive along one axis are
+* separated by a single gap of that axis, so their pairs only share lines through
+* the other axis, and the largest set of them with disjoint rank ranges on the
+* other axis is found by the earliest end first interval scheduling in O(n).
+*/
+
+#include "LowerBounds.h"
+
+/* Smallest k such that k lines split as evenly as possible make at least n cells */
+int GetCountingBound(int numberOfPoints)
+{
+	long long k = 0;
+	while ((k + 2) / 2 * ((k + 3) / 2) < numberOfPoints)
+	{
+		k++;
+	}
+	return ((int)k);
+}
+
+/* Number of points of the longest chain increasing in x and increasing or decreasing in y */
+int GetLongestChain(Solver *solver, int isDecreasing)
+{
+	int n = solver->myNumberOfPoints;
+	int *tails = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * (size_t)(n > 0 ? n : 1));
+	int length = 0;
+	int index = 0;
+	while (index < n)
+	{
+		int rank = solver->myOtherRanks[X][index];
+		if (isDecreasing)
+		{
+			rank = n - 1 - rank;
+		}
+
+		/* tails[i] is the smallest last rank of a chain of i + 1 points */
+		int low = 0;
+		int high = length;
+		while (low < high)
+		{
+			int middle = (low + high) / 2;
+			if (tails[middle] < rank)
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+		tails[low] = rank;
+		if (low == length)
+		{
+			length++;
+		}
+		index++;
+	}
+	return (length);
+}
+
+/* Largest number of pairs of points consecutive along the axis whose rank ranges on the other axis
+ * are disjoint. The pair needs a gap between the lower rank and the higher rank - 1
+ */
+int GetNeighbourPacking(Solver *solver, int axis)
+{
+	int n = solver->myNumberOfPoints;
+	const int *otherRanks = solver->myOtherRanks[axis];
+
+	/* latest start of the ranges ending at every gap */
+	int *latestStart = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * (size_t)(n > 0 ? n : 1));
+	memset(latestStart, -1, sizeof(int) * (size_t)(n > 0 ? n : 1));
+	int index = 0;
+	while (index < n - 1)
+	{
+		int rank1 = otherRanks[index];
+		int rank2 = otherRanks[index + 1];
+		int start = rank1 < rank2 ? rank1 : rank2;
+		int end = (rank1 < rank2 ? rank2 : rank1) - 1;
+		if (start > latestStart[end])
+		{
+			latestStart[end] = start;
+		}
+		index++;
+	}
+
+	int packing = 0;
+	int lastEnd = -1;
+	int end = 0;
+	while (end < n - 1)
+	{
+		if (latestStart[end] > lastEnd)
+		{
+			packing++;
+			lastEnd = end;
+		}
+		end++;
+	}
+	return (packing);
+}
+
+/* Compute the bounds of the sorted instance held by the solver */
+void ComputeLowerBounds(Solver *solver)
+{
+	LowerBounds *bounds = &solver->myBounds;
+	bounds->counting = GetCountingBound(solver->myNumberOfPoints);
+	bounds->increasing = GetLongestChain(solver, 0) - 1;
+	bounds->decreasing = GetLongestChain(solver, 1) - 1;
+	bounds->neighbours[X] = GetNeighbourPacking(solver, X);
+	bounds->neighbours[Y] = GetNeighbourPacking(solver, Y);
+	bounds->best = bounds->counting;
+	if (bounds->increasing > bounds->best)
+	{
+		bounds->best = bounds->increasing;
+	}
+	if (bounds->decreasing > bounds->best)
+	{
+		bounds->best = bounds->decreasing;
+	}
+	if (bounds->neighbours[X] > bounds->best)
+	{
+		bounds->best = bounds->neighbours[X];
+	}
+	if (bounds->neighbours[Y] > bounds->best)
+	{
+		bounds->best = bounds->neighbours[Y];
+	}
+}
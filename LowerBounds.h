@@ -0,0 +1,17 @@
+#pragma once
+#ifndef LOWER_BOUNDS_H
+#define  LOWER_BOUNDS_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	BOUND_REPORT "Bound %s: %d lines, lower bound %d (cells %d, chains %d/%d, neighbours %d/%d), gap %d\n"
+
+/* Functions */
+int GetCountingBound(int numberOfPoints);
+int GetLongestChain(Solver *solver, int isDecreasing);
+int GetNeighbourPacking(Solver *solver, int axis);
+void ComputeLowerBounds(Solver *solver);
+
+#endif
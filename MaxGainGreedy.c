@@ -0,0 +1,206 @@
+/* Max gain greedy. Every step commits the gap, of either axis, that separates the
+* most pairs of points still sharing a cell. The gains of all the gaps of a slab
+* are found in one sweep over its points, so the queue holds slabs keyed by their
+* best gap. Committing a line only ever splits cells, so the gain of a gap never
+* grows and a gain computed earlier is an upper bound of the current one. A commit
+* changes the gains of its own axis only in the slab it splits, which is evaluated
+* again right away, but may change the gains of every slab of the other axis. Those
+* are updated lazily: the best gap of the top slab is committed when the slab was
+* evaluated after the last commit on the other axis, otherwise the slab is
+* evaluated again and the top is looked at anew.
+*/
+
+#include "MaxGainGreedy.h"
+
+/* The slab with the larger gain comes first, the lower id breaks ties */
+int IsBefore(const GainQueue *queue, int id1, int id2)
+{
+	if (queue->gain[id1] != queue->gain[id2])
+	{
+		return (queue->gain[id1] > queue->gain[id2]);
+	}
+	return (id1 < id2);
+}
+
+void SwapQueueEntries(GainQueue *queue, int i, int j)
+{
+	int id = queue->heap[i];
+	queue->heap[i] = queue->heap[j];
+	queue->heap[j] = id;
+	queue->position[queue->heap[i]] = i;
+	queue->position[queue->heap[j]] = j;
+}
+
+void SiftUp(GainQueue *queue, int i)
+{
+	while (i > 0 && IsBefore(queue, queue->heap[i], queue->heap[(i - 1) / 2]))
+	{
+		SwapQueueEntries(queue, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+void SiftDown(GainQueue *queue, int i)
+{
+	for (;;)
+	{
+		int best = i;
+		int child = 2 * i + 1;
+		if (child < queue->size && IsBefore(queue, queue->heap[child], queue->heap[best]))
+		{
+			best = child;
+		}
+		child++;
+		if (child < queue->size && IsBefore(queue, queue->heap[child], queue->heap[best]))
+		{
+			best = child;
+		}
+		if (best == i)
+		{
+			return;
+		}
+		SwapQueueEntries(queue, i, best);
+		i = best;
+	}
+}
+
+/* Remove the slab at the given heap position */
+void RemoveFromQueue(GainQueue *queue, int i)
+{
+	int id = queue->heap[i];
+	queue->size--;
+	if (i < queue->size)
+	{
+		SwapQueueEntries(queue, i, queue->size);
+		SiftDown(queue, i);
+		SiftUp(queue, i);
+	}
+	queue->position[id] = -1;
+}
+
+void InitializeGainQueue(Solver *solver, GainQueue *queue)
+{
+	int n = solver->myNumberOfPoints;
+	queue->heap = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * 2 * n);
+	queue->position = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * 2 * n);
+	queue->gain = (long long *)ArenaAlloc(&solver->myArena, sizeof(long long) * 2 * n);
+	queue->bestGap = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * 2 * n);
+	queue->evaluatedAt = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * 2 * n);
+	queue->cellLeft = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	queue->cellLeftMark = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	memset(queue->position, -1, sizeof(int) * 2 * n);
+	memset(queue->cellLeftMark, 0, sizeof(int) * n);
+	queue->size = 0;
+	queue->epoch = 0;
+	queue->changedAt[X] = solver->myNumberOfLines;
+	queue->changedAt[Y] = solver->myNumberOfLines;
+}
+
+/* Evaluate the gains of every gap of the slab starting at the given rank and requeue the slab
+ * under its best one. Sweeping the slab from the left, moving a point of a cell of size S with
+ * L points already on the left changes the number of separated pairs by
+ * (L + 1)(S - L - 1) - L(S - L) = S - 2L - 1
+ */
+void EvaluateSlab(Solver *solver, GainQueue *queue, int axis, int from)
+{
+	const int *ls = solver->mySortedIds[axis];
+	int to = NextCommittedGap(solver, axis, from - 1);
+	queue->epoch++;
+	long long gain = 0;
+	long long bestGain = 0;
+	int bestGap = from;
+	int rank = from;
+	while (rank < to)
+	{
+		int cell = solver->myCellOfPoint[ls[rank]];
+		if (queue->cellLeftMark[cell] != queue->epoch)
+		{
+			queue->cellLeftMark[cell] = queue->epoch;
+			queue->cellLeft[cell] = 0;
+		}
+		gain += solver->myCellSize[cell] - 2 * queue->cellLeft[cell] - 1;
+		queue->cellLeft[cell]++;
+		if (gain > bestGain)
+		{
+			bestGain = gain;
+			bestGap = rank;
+		}
+		rank++;
+	}
+
+	int id = 2 * from + axis;
+	queue->gain[id] = bestGain;
+	queue->bestGap[id] = bestGap;
+	queue->evaluatedAt[id] = solver->myNumberOfLines;
+	if (queue->position[id] < 0)
+	{
+		if (bestGain > 0)
+		{
+			queue->heap[queue->size] = id;
+			queue->position[id] = queue->size;
+			queue->size++;
+			SiftUp(queue, queue->position[id]);
+		}
+		return;
+	}
+	if (bestGain == 0)
+	{
+		RemoveFromQueue(queue, queue->position[id]);
+		return;
+	}
+
+	/* gains only drop, but the queue does not rely on it */
+	SiftDown(queue, queue->position[id]);
+	SiftUp(queue, queue->position[id]);
+}
+
+/* Commit the gap with the largest gain until no two points share a cell */
+void CommitMaxGainLines(Solver *solver)
+{
+	if (solver->myNumberOfPoints < 2)
+	{
+		return;
+	}
+
+	/* every candidate line by gap, the greedy picks lines by gap rather than in list order */
+	int index = 0;
+	while (index < solver->myNumberOfLinesInXAxis)
+	{
+		solver->myLineAtGap[X][solver->myXAxisLines[index].leftRank] = &solver->myXAxisLines[index];
+		index++;
+	}
+	index = 0;
+	while (index < solver->myNumberOfLinesInYAxis)
+	{
+		solver->myLineAtGap[Y][solver->myYAxisLines[index].leftRank] = &solver->myYAxisLines[index];
+		index++;
+	}
+
+	GainQueue queue;
+	InitializeGainQueue(solver, &queue);
+	EvaluateSlab(solver, &queue, X, 0);
+	EvaluateSlab(solver, &queue, Y, 0);
+	int steps = 0;
+	while (solver->myRemainingConnections && queue.size > 0)
+	{
+		if ((++steps & 63) == 0 && IsPastDeadline(solver))
+		{
+			break;
+		}
+		int id = queue.heap[0];
+		int axis = id % 2;
+		int from = id / 2;
+		if (queue.evaluatedAt[id] < queue.changedAt[axis])
+		{
+			EvaluateSlab(solver, &queue, axis, from);
+			continue;
+		}
+
+		/* the slab splits in two, both halves are evaluated again */
+		int gap = queue.bestGap[id];
+		CommitLine(solver, solver->myLineAtGap[axis][gap]);
+		queue.changedAt[axis == X ? Y : X] = solver->myNumberOfLines;
+		EvaluateSlab(solver, &queue, axis, from);
+		EvaluateSlab(solver, &queue, axis, gap + 1);
+	}
+}
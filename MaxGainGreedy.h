@@ -0,0 +1,39 @@
+#pragma once
+#ifndef MAX_GAIN_GREEDY_H
+#define  MAX_GAIN_GREEDY_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	MAX_GAIN_ENGINE_ERR "The maxgain greedy needs the cell engine\n"
+
+/* Type Definitions */
+
+/* Indexed max heap over the slabs of both axes, the slab starting at rank r of axis a
+ * has the id 2 * r + a. A slab is keyed by the largest number of connected pairs one
+ * of its gaps would separate, an upper bound unless it was evaluated since the last
+ * commit on the other axis. Slabs without any connected pair are left out
+ */
+typedef struct gainQueue
+{
+	int *heap;
+	int *position;
+	int size;
+	long long *gain;
+	int *bestGap;
+	int *evaluatedAt;
+
+	/* Number of lines after the last commit that changed the gains of each axis as a whole */
+	int changedAt[2];
+
+	/* Points of every cell on the left of the sweep, valid when the mark equals the epoch */
+	int *cellLeft;
+	int *cellLeftMark;
+	int epoch;
+} GainQueue;
+
+/* Functions */
+void CommitMaxGainLines(Solver *solver);
+
+#endif
@@ -0,0 +1,169 @@
+/* Multi-start solver. Restart 0 is the plain deterministic pipeline, every other
+* restart seeds its own random state from the seed and its index and then splits
+* the candidate ranges at random ranks, flips a coin for the axis that goes first
+* at every greedy step and for the axis swept first by every round of the
+* redundant line removal. The restarts run on a work pool, each worker with its
+* own solver, and the solution with the fewest lines wins, the lowest restart
+* breaking ties, so the result only depends on the seed and never on the timing.
+*/
+
+#include "MultiStart.h"
+#include "WorkPool.h"
+#include "LowerBounds.h"
+
+/* Solve the instance of the source on an empty solver as the given restart */
+void RunRestart(Solver *solver, const Solver *source, int restart)
+{
+	ResetSolverStorage(solver);
+	CopyInstance(solver, source);
+	solver->myIsRandomized = restart > 0;
+	solver->myRandomState = source->mySeed + (unsigned long long)restart * 0x9E3779B97F4A7C15ULL;
+	Solve(solver);
+}
+
+/* Keep the solution of the solver in the result if it has fewer lines, the lower restart winning ties */
+void KeepBestSolution(Solver *solver, int restart, RestartResult *result)
+{
+	int numberOfLines = CountCommittedLines(solver);
+	if (result->restart >= 0 && (numberOfLines > result->numberOfLines ||
+		(numberOfLines == result->numberOfLines && restart > result->restart)))
+	{
+		return;
+	}
+	result->numberOfLines = 0;
+	result->restart = restart;
+	result->isFinished = solver->myIsFinished;
+	result->stats = solver->myStats;
+	int index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[index];
+		if (l->isCommitted)
+		{
+			result->lines[result->numberOfLines++] = 2 * l->leftRank + l->lineAxis;
+		}
+		index++;
+	}
+}
+
+/* Solve one restart on the solver of the worker and keep it if it beats the worker's best */
+void SolveRestart(void *context, int task, int worker)
+{
+	MultiStart *multiStart = (MultiStart *)context;
+	Solver *solver = &multiStart->solvers[worker];
+	RunRestart(solver, multiStart->source, task);
+	KeepBestSolution(solver, task, &multiStart->results[worker]);
+}
+
+/* Make the lines of the result the solution of the solver, which holds the unsolved instance */
+void AdoptSolution(Solver *solver, const RestartResult *result)
+{
+	SortInputPoints(solver);
+	ComputeLowerBounds(solver);
+	CommitResultLines(solver, result);
+}
+
+/* Commit the lines of the result on the solver, whose points are sorted but have no lines yet */
+void CommitResultLines(Solver *solver, const RestartResult *result)
+{
+	InitializeCommittedGaps(solver);
+	AddLines(solver, X, 0, solver->myNumberOfPoints - 1);
+	AddLines(solver, Y, 0, solver->myNumberOfPoints - 1);
+
+	int index = 0;
+	while (index < solver->myNumberOfLinesInXAxis)
+	{
+		solver->myLineAtGap[X][solver->myXAxisLines[index].leftRank] = &solver->myXAxisLines[index];
+		index++;
+	}
+	index = 0;
+	while (index < solver->myNumberOfLinesInYAxis)
+	{
+		solver->myLineAtGap[Y][solver->myYAxisLines[index].leftRank] = &solver->myYAxisLines[index];
+		index++;
+	}
+
+	index = 0;
+	while (index < result->numberOfLines)
+	{
+		int axis = result->lines[index] % 2;
+		int rank = result->lines[index] / 2;
+		Line *l = solver->myLineAtGap[axis][rank];
+		l->isCommitted = 1;
+		solver->myCommittedLines[solver->myNumberOfLines++] = l;
+		solver->myCommittedGaps[axis][rank / CONNECTION_WORD_BITS] |= (ConnectionWord)1 << (rank % CONNECTION_WORD_BITS);
+		index++;
+	}
+	solver->myRemainingConnections = 0;
+}
+
+/* Run the restarts of the instance held by the solver and leave the best solution in it */
+void SolveMultiStart(Solver *solver)
+{
+	int numberOfRestarts = solver->myNumberOfRestarts;
+	int numberOfWorkers = solver->myRestartWorkers;
+	if (numberOfWorkers < 1)
+	{
+		numberOfWorkers = GetNumberOfCores();
+	}
+	if (numberOfWorkers > numberOfRestarts)
+	{
+		numberOfWorkers = numberOfRestarts;
+	}
+
+	MultiStart multiStart;
+	multiStart.source = solver;
+	multiStart.solvers = (Solver *)AllocateStorage(sizeof(Solver) * numberOfWorkers);
+	multiStart.results = (RestartResult *)AllocateStorage(sizeof(RestartResult) * numberOfWorkers);
+	int *tasks = (int *)AllocateStorage(sizeof(int) * numberOfRestarts);
+	int index = 0;
+	while (index < numberOfWorkers)
+	{
+		CopySolverSettings(&multiStart.solvers[index], solver);
+		multiStart.solvers[index].myNumberOfRestarts = 1;
+		multiStart.results[index].restart = -1;
+		multiStart.results[index].numberOfLines = 0;
+		multiStart.results[index].lines = (int *)AllocateStorage(sizeof(int) * 2 * (size_t)solver->myNumberOfPoints);
+		index++;
+	}
+	index = 0;
+	while (index < numberOfRestarts)
+	{
+		tasks[index] = index;
+		index++;
+	}
+
+	RunWorkPool(numberOfWorkers, tasks, numberOfRestarts, &SolveRestart, &multiStart);
+
+	RestartResult *best = &multiStart.results[0];
+	index = 1;
+	while (index < numberOfWorkers)
+	{
+		RestartResult *result = &multiStart.results[index];
+		if (result->restart >= 0 && (best->restart < 0 || result->numberOfLines < best->numberOfLines ||
+			(result->numberOfLines == best->numberOfLines && result->restart < best->restart)))
+		{
+			best = result;
+		}
+		index++;
+	}
+	AdoptSolution(solver, best);
+	solver->myIsFinished = best->isFinished;
+	solver->myNumberOfRuns = numberOfRestarts;
+
+	/* the statistics of the winning restart, but the parse time of the caller's file */
+	double parseTime = solver->myStats.phaseTime[PARSE_PHASE];
+	solver->myStats = best->stats;
+	solver->myStats.phaseTime[PARSE_PHASE] = parseTime;
+
+	index = 0;
+	while (index < numberOfWorkers)
+	{
+		free(multiStart.results[index].lines);
+		FreeSolver(&multiStart.solvers[index]);
+		index++;
+	}
+	free(tasks);
+	free(multiStart.results);
+	free(multiStart.solvers);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef MULTI_START_H
+#define  MULTI_START_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	DEFAULT_SEED	0x5EEDULL
+
+/* Type Definitions */
+
+/* Best solution found by one worker, every line is stored as 2 * leftRank + axis.
+ * The statistics and the finished flag are those of the restart that found it
+ */
+typedef struct restartResult
+{
+	int numberOfLines;
+	int restart;
+	int *lines;
+	int isFinished;
+	SolverStats stats;
+} RestartResult;
+
+/* Shared state of the restarts of one instance, every worker owns a solver and a result */
+typedef struct multiStart
+{
+	Solver *source;
+	Solver *solvers;
+	RestartResult *results;
+} MultiStart;
+
+/* Functions */
+void RunRestart(Solver *solver, const Solver *source, int restart);
+void KeepBestSolution(Solver *solver, int restart, RestartResult *result);
+void AdoptSolution(Solver *solver, const RestartResult *result);
+void CommitResultLines(Solver *solver, const RestartResult *result);
+void SolveMultiStart(Solver *solver);
+
+#endif
@@ -0,0 +1,302 @@
+/* Point location over a solution. The committed lines of each axis are kept as a
+* sorted array of coordinates, and a query lies in the cell of the slab and band
+* given by the number of lines below it on each axis. The count is a branchless
+* binary search: the range halves at every step and the comparison only moves the
+* base, so the loop compiles to conditional moves, runs the same number of steps
+* for every query and never mispredicts. Queries are searched in groups that step
+* through the levels together, so the loads of a group are in flight at the same
+* time instead of one after the other. The cell table is dense, one entry per
+* cell, unless the lines make far more cells than points, in which case the
+* occupied cells are kept sorted and searched the same way. Large batches are cut
+* into chunks for the work pool.
+*/
+
+#include "PointLocation.h"
+#include "WorkPool.h"
+#include "RadixSort.h"
+
+int SortByLineCoordinate(const void *ptr1, const void *ptr2)
+{
+	double coordinate1 = *(const double *)ptr1;
+	double coordinate2 = *(const double *)ptr2;
+	return (coordinate1 < coordinate2 ? -1 : (coordinate1 > coordinate2));
+}
+
+/* Number of lines strictly below the value, a query on a line belongs to the cell above it */
+int CountLinesBelow(const double *lines, int numberOfLines, double value)
+{
+	if (numberOfLines == 0)
+	{
+		return (0);
+	}
+	const double *base = lines;
+	int n = numberOfLines;
+	while (n > 1)
+	{
+		int half = n / 2;
+		base = base[half] < value ? base + half : base;
+		n -= half;
+	}
+	return ((int)(base - lines) + (*base < value));
+}
+
+/* Number of lines below every query of a group, all of them searched level by level together */
+void CountGroupBelow(const double *lines, int numberOfLines, const double *values, int count, int *below)
+{
+	int k = 0;
+	while (k < count)
+	{
+		below[k] = 0;
+		k++;
+	}
+	if (numberOfLines == 0)
+	{
+		return;
+	}
+	int n = numberOfLines;
+	while (n > 1)
+	{
+		int half = n / 2;
+		k = 0;
+		while (k < count)
+		{
+			below[k] = lines[below[k] + half] < values[k] ? below[k] + half : below[k];
+			k++;
+		}
+		n -= half;
+	}
+	k = 0;
+	while (k < count)
+	{
+		below[k] += lines[below[k]] < values[k];
+		k++;
+	}
+}
+
+long long GetCellOf(const PointLocation *index, int slab, int band)
+{
+	return ((long long)slab * (index->numberOfLines[Y] + 1) + band);
+}
+
+long long LocateCell(const PointLocation *index, double xValue, double yValue)
+{
+	return (GetCellOf(index, CountLinesBelow(index->lines[X], index->numberOfLines[X], xValue),
+		CountLinesBelow(index->lines[Y], index->numberOfLines[Y], yValue)));
+}
+
+/* Get the point of the cell, -1 if the cell is empty */
+int GetPointOfCell(const PointLocation *index, long long cell)
+{
+	if (index->pointOfCell != NULL)
+	{
+		return (index->pointOfCell[cell]);
+	}
+	if (index->numberOfKeys == 0)
+	{
+		return (-1);
+	}
+	const long long *base = index->cellKeys;
+	int n = index->numberOfKeys;
+	while (n > 1)
+	{
+		int half = n / 2;
+		base = base[half] <= cell ? base + half : base;
+		n -= half;
+	}
+	return (*base == cell ? index->cellPoints[base - index->cellKeys] : -1);
+}
+
+/* Build the index of the solution held by a solved solver, the point ids being the input order */
+void BuildPointLocation(PointLocation *index, Solver *solver)
+{
+	memset(index, 0, sizeof(PointLocation));
+	int n = solver->myNumberOfPoints;
+	index->lines[X] = (double *)AllocateStorage(sizeof(double) * (size_t)(solver->myNumberOfLines + 1));
+	index->lines[Y] = (double *)AllocateStorage(sizeof(double) * (size_t)(solver->myNumberOfLines + 1));
+	int line = 0;
+	while (line < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[line];
+		if (l->isCommitted)
+		{
+			index->lines[l->lineAxis][index->numberOfLines[l->lineAxis]++] = (double)GetDoubledIntersectionValue(solver, l) / 2;
+		}
+		line++;
+	}
+	qsort(index->lines[X], (size_t)index->numberOfLines[X], sizeof(double), &SortByLineCoordinate);
+	qsort(index->lines[Y], (size_t)index->numberOfLines[Y], sizeof(double), &SortByLineCoordinate);
+	index->numberOfCells = (long long)(index->numberOfLines[X] + 1) * (index->numberOfLines[Y] + 1);
+
+	if (index->numberOfCells <= (long long)LOCATE_DENSE_FACTOR * (n + 1))
+	{
+		index->pointOfCell = (int *)AllocateStorage(sizeof(int) * (size_t)index->numberOfCells);
+		memset(index->pointOfCell, 0xff, sizeof(int) * (size_t)index->numberOfCells);
+		int point = 0;
+		while (point < n)
+		{
+			index->pointOfCell[LocateCell(index, solver->myValues[X][point], solver->myValues[Y][point])] = point;
+			point++;
+		}
+		return;
+	}
+
+	/* cells radix sorted with their points */
+	uint64_t *keys = (uint64_t *)AllocateStorage(sizeof(uint64_t) * 2 * (size_t)(n + 1));
+	int *points = (int *)AllocateStorage(sizeof(int) * (size_t)(n + 1));
+	index->cellKeys = (long long *)AllocateStorage(sizeof(long long) * (size_t)(n + 1));
+	index->cellPoints = (int *)AllocateStorage(sizeof(int) * (size_t)(n + 1));
+	index->numberOfKeys = n;
+	int point = 0;
+	while (point < n)
+	{
+		keys[point] = (uint64_t)LocateCell(index, solver->myValues[X][point], solver->myValues[Y][point]);
+		index->cellPoints[point] = point;
+		point++;
+	}
+	int numberOfWorkers = solver->myRestartWorkers > 0 ? solver->myRestartWorkers : GetNumberOfCores();
+	RadixSortKeys(keys, index->cellPoints, keys + n + 1, points, (size_t)n, numberOfWorkers);
+	point = 0;
+	while (point < n)
+	{
+		index->cellKeys[point] = (long long)keys[point];
+		point++;
+	}
+	free(points);
+	free(keys);
+}
+
+void FreePointLocation(PointLocation *index)
+{
+	free(index->lines[X]);
+	free(index->lines[Y]);
+	free(index->pointOfCell);
+	free(index->cellKeys);
+	free(index->cellPoints);
+}
+
+/* Locate the queries of a range, group by group */
+void LocateRange(const LocateBatch *batch, int from, int to)
+{
+	const PointLocation *index = batch->index;
+	int slabs[LOCATE_GROUP];
+	int bands[LOCATE_GROUP];
+	int first = from;
+	while (first < to)
+	{
+		int count = to - first < LOCATE_GROUP ? to - first : LOCATE_GROUP;
+		CountGroupBelow(index->lines[X], index->numberOfLines[X], &batch->xValues[first], count, slabs);
+		CountGroupBelow(index->lines[Y], index->numberOfLines[Y], &batch->yValues[first], count, bands);
+		int k = 0;
+		while (k < count)
+		{
+			long long cell = GetCellOf(index, slabs[k], bands[k]);
+			batch->cells[first + k] = cell;
+			if (batch->points != NULL)
+			{
+				batch->points[first + k] = GetPointOfCell(index, cell);
+			}
+			k++;
+		}
+		first += count;
+	}
+}
+
+void LocateChunk(void *context, int task, int worker)
+{
+	(void)worker;
+	const LocateBatch *batch = (const LocateBatch *)context;
+	long long from = (long long)task * LOCATE_CHUNK;
+	long long to = from + LOCATE_CHUNK < batch->numberOfQueries ? from + LOCATE_CHUNK : batch->numberOfQueries;
+	LocateRange(batch, (int)from, (int)to);
+}
+
+/* Store the cell of every query and, when points is not NULL, the point of that cell or -1 */
+void LocatePoints(const PointLocation *index, const double *xValues, const double *yValues, int numberOfQueries,
+	long long *cells, int *points, int numberOfWorkers)
+{
+	LocateBatch batch;
+	batch.index = index;
+	batch.xValues = xValues;
+	batch.yValues = yValues;
+	batch.numberOfQueries = numberOfQueries;
+	batch.cells = cells;
+	batch.points = points;
+
+	int numberOfChunks = (int)(((long long)numberOfQueries + LOCATE_CHUNK - 1) / LOCATE_CHUNK);
+	if (numberOfWorkers > numberOfChunks)
+	{
+		numberOfWorkers = numberOfChunks;
+	}
+	if (numberOfWorkers <= 1)
+	{
+		LocateRange(&batch, 0, numberOfQueries);
+		return;
+	}
+	int *tasks = (int *)AllocateStorage(sizeof(int) * (size_t)numberOfChunks);
+	int task = 0;
+	while (task < numberOfChunks)
+	{
+		tasks[task] = task;
+		task++;
+	}
+	RunWorkPool(numberOfWorkers, tasks, numberOfChunks, &LocateChunk, &batch);
+	free(tasks);
+}
+
+/* Time a batch of queries over the solution held by the solver. Every other query is an input
+ * point, which must find its own cell, the rest are spread over the bounding box
+ */
+void RunLocateBenchmark(Solver *solver, char *fileName, int numberOfQueries)
+{
+	int n = solver->myNumberOfPoints;
+	PointLocation index;
+	BuildPointLocation(&index, solver);
+
+	int minX = solver->mySortedValues[X][0];
+	int maxX = solver->mySortedValues[X][n - 1];
+	int minY = solver->mySortedValues[Y][0];
+	int maxY = solver->mySortedValues[Y][n - 1];
+
+	double *xValues = (double *)AllocateStorage(sizeof(double) * (size_t)numberOfQueries);
+	double *yValues = (double *)AllocateStorage(sizeof(double) * (size_t)numberOfQueries);
+	long long *cells = (long long *)AllocateStorage(sizeof(long long) * (size_t)numberOfQueries);
+	int *points = (int *)AllocateStorage(sizeof(int) * (size_t)numberOfQueries);
+	unsigned long long state = LOCATE_SEED;
+	int query = 0;
+	while (query < numberOfQueries)
+	{
+		if (query % 2 == 0)
+		{
+			int point = (int)(NextRandom(&state) % (unsigned long long)n);
+			xValues[query] = solver->myValues[X][point];
+			yValues[query] = solver->myValues[Y][point];
+		}
+		else
+		{
+			xValues[query] = minX + (double)(NextRandom(&state) >> 11) / 9007199254740992.0 * ((double)maxX - minX);
+			yValues[query] = minY + (double)(NextRandom(&state) >> 11) / 9007199254740992.0 * ((double)maxY - minY);
+		}
+		query++;
+	}
+
+	int numberOfWorkers = solver->myRestartWorkers < 1 ? GetNumberOfCores() : solver->myRestartWorkers;
+	double start = GetWallClock();
+	LocatePoints(&index, xValues, yValues, numberOfQueries, cells, points, numberOfWorkers);
+	double elapsed = GetWallClock() - start;
+
+	int hits = 0;
+	query = 0;
+	while (query < numberOfQueries)
+	{
+		hits += points[query] >= 0;
+		query++;
+	}
+	printf(LOCATE_REPORT, fileName, numberOfQueries, elapsed * 1000,
+		elapsed > 0 ? numberOfQueries / elapsed / 1e6 : 0.0, index.numberOfCells, hits);
+
+	free(xValues);
+	free(yValues);
+	free(cells);
+	free(points);
+	FreePointLocation(&index);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef POINT_LOCATION_H
+#define  POINT_LOCATION_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	LOCATE_REPORT "Locate %s: %d queries in %.3f ms, %.1f million queries/s, %lld cells, %d hits\n"
+#define	LOCATE_MODE_ERR "The query benchmark runs on single files, without -j\n"
+#define	LOCATE_SEED	0x10CA7E5ULL
+
+/* Queries searched side by side, their loads overlap instead of waiting on each other */
+#define	LOCATE_GROUP	16
+
+/* Queries per task of the work pool */
+#define	LOCATE_CHUNK	(1 << 16)
+
+/* The cell table is dense while it has at most this many cells per point */
+#define	LOCATE_DENSE_FACTOR	8
+
+/* Type Definitions */
+
+/* Query index over a solution. A query lies in the cell of the slab and band given by the
+ * number of lines below it on each axis, and the table gives the point of every cell
+ */
+typedef struct pointLocation
+{
+	double *lines[2];
+	int numberOfLines[2];
+	long long numberOfCells;
+
+	/* Dense table of the point of every cell, -1 for an empty cell, or NULL when sparse */
+	int *pointOfCell;
+
+	/* Sparse table: the occupied cells sorted, and their points */
+	long long *cellKeys;
+	int *cellPoints;
+	int numberOfKeys;
+} PointLocation;
+
+/* A batch of queries shared by the workers, the results go to cells and points */
+typedef struct locateBatch
+{
+	const PointLocation *index;
+	const double *xValues;
+	const double *yValues;
+	int numberOfQueries;
+	long long *cells;
+	int *points;
+} LocateBatch;
+
+/* Functions */
+void BuildPointLocation(PointLocation *index, Solver *solver);
+void FreePointLocation(PointLocation *index);
+long long LocateCell(const PointLocation *index, double xValue, double yValue);
+int GetPointOfCell(const PointLocation *index, long long cell);
+void LocatePoints(const PointLocation *index, const double *xValues, const double *yValues, int numberOfQueries,
+	long long *cells, int *points, int numberOfWorkers);
+void RunLocateBenchmark(Solver *solver, char *fileName, int numberOfQueries);
+
+#endif
@@ -0,0 +1,166 @@
+/* LSD radix sort of 64 bit keys, each carrying an optional int value. Every pass
+* distributes the keys on one byte, from the lowest up, and is stable, so keys
+* sorting equal keep the order they came in. Bytes that are the same in every key
+* are found up front from the AND and the OR of all keys and skipped, which leaves
+* four passes for coordinates and two or three for keys made of ranks. Above
+* RADIX_PARALLEL_MIN keys every pass runs on the work pool: each worker counts the
+* digits of its own chunk, the counts are turned into one output position per
+* digit and chunk, and each worker then scatters its chunk in order.
+*/
+
+#include "RadixSort.h"
+#include "WorkPool.h"
+
+size_t GetChunkStart(const RadixSort *sort, int chunk)
+{
+	return (sort->count / (size_t)sort->numberOfChunks * (size_t)chunk + (size_t)(chunk < (int)(sort->count % (size_t)sort->numberOfChunks) ? chunk : (int)(sort->count % (size_t)sort->numberOfChunks)));
+}
+
+void CountDigits(void *context, int task, int worker)
+{
+	(void)worker;
+	const RadixSort *sort = (const RadixSort *)context;
+	const uint64_t *keys = sort->keys;
+	int shift = sort->shift;
+	size_t counts[RADIX_BUCKETS];
+	memset(counts, 0, sizeof(counts));
+	size_t index = GetChunkStart(sort, task);
+	size_t end = GetChunkStart(sort, task + 1);
+	while (index < end)
+	{
+		counts[keys[index] >> shift & (RADIX_BUCKETS - 1)]++;
+		index++;
+	}
+	memcpy(&sort->histograms[(size_t)task * RADIX_BUCKETS], counts, sizeof(counts));
+}
+
+/* The positions are copied to the stack, the stores to the buffers could otherwise alias them */
+void ScatterDigits(void *context, int task, int worker)
+{
+	(void)worker;
+	const RadixSort *sort = (const RadixSort *)context;
+	const uint64_t *keys = sort->keys;
+	const int *values = sort->values;
+	uint64_t *keyBuffer = sort->keyBuffer;
+	int *valueBuffer = sort->valueBuffer;
+	int shift = sort->shift;
+	size_t position[RADIX_BUCKETS];
+	memcpy(position, &sort->histograms[(size_t)task * RADIX_BUCKETS], sizeof(position));
+	size_t index = GetChunkStart(sort, task);
+	size_t end = GetChunkStart(sort, task + 1);
+	if (values == NULL)
+	{
+		while (index < end)
+		{
+			uint64_t key = keys[index];
+			keyBuffer[position[key >> shift & (RADIX_BUCKETS - 1)]++] = key;
+			index++;
+		}
+		return;
+	}
+	while (index < end)
+	{
+		uint64_t key = keys[index];
+		size_t target = position[key >> shift & (RADIX_BUCKETS - 1)]++;
+		keyBuffer[target] = key;
+		valueBuffer[target] = values[index];
+		index++;
+	}
+}
+
+/* Run one step of a pass on every chunk, on the pool when there is more than one */
+void RunRadixStep(RadixSort *sort, WorkTask step, int *tasks)
+{
+	if (sort->numberOfChunks == 1)
+	{
+		step(sort, 0, 0);
+		return;
+	}
+	RunWorkPool(sort->numberOfChunks, tasks, sort->numberOfChunks, step, sort);
+}
+
+/* Sort the keys, and the values along with them when values is not NULL. The buffers hold
+ * as many entries as the keys, the result ends up in keys and values
+ */
+void RadixSortKeys(uint64_t *keys, int *values, uint64_t *keyBuffer, int *valueBuffer, size_t count, int numberOfWorkers)
+{
+	if (count < 2)
+	{
+		return;
+	}
+	uint64_t all = ~0ULL;
+	uint64_t any = 0;
+	size_t index = 0;
+	while (index < count)
+	{
+		all &= keys[index];
+		any |= keys[index];
+		index++;
+	}
+	uint64_t varying = all ^ any;
+
+	RadixSort sort;
+	sort.keys = keys;
+	sort.values = values;
+	sort.keyBuffer = keyBuffer;
+	sort.valueBuffer = valueBuffer;
+	sort.count = count;
+	sort.numberOfChunks = count >= RADIX_PARALLEL_MIN && numberOfWorkers > 1 ? numberOfWorkers : 1;
+	sort.histograms = (size_t *)AllocateStorage(sizeof(size_t) * RADIX_BUCKETS * (size_t)sort.numberOfChunks);
+	int *tasks = (int *)AllocateStorage(sizeof(int) * (size_t)sort.numberOfChunks);
+	int chunk = 0;
+	while (chunk < sort.numberOfChunks)
+	{
+		tasks[chunk] = chunk;
+		chunk++;
+	}
+
+	sort.shift = 0;
+	while (sort.shift < 64)
+	{
+		if ((varying >> sort.shift & (RADIX_BUCKETS - 1)) == 0)
+		{
+			sort.shift += RADIX_BITS;
+			continue;
+		}
+		RunRadixStep(&sort, &CountDigits, tasks);
+
+		/* digit by digit, chunk by chunk: the first position each chunk writes a digit to */
+		size_t position = 0;
+		int digit = 0;
+		while (digit < RADIX_BUCKETS)
+		{
+			chunk = 0;
+			while (chunk < sort.numberOfChunks)
+			{
+				size_t *entry = &sort.histograms[(size_t)chunk * RADIX_BUCKETS + (size_t)digit];
+				size_t digitCount = *entry;
+				*entry = position;
+				position += digitCount;
+				chunk++;
+			}
+			digit++;
+		}
+		RunRadixStep(&sort, &ScatterDigits, tasks);
+
+		uint64_t *swapKeys = sort.keys;
+		sort.keys = sort.keyBuffer;
+		sort.keyBuffer = swapKeys;
+		int *swapValues = sort.values;
+		sort.values = sort.valueBuffer;
+		sort.valueBuffer = swapValues;
+		sort.shift += RADIX_BITS;
+	}
+
+	/* an odd number of passes leaves the result in the buffers */
+	if (sort.keys != keys)
+	{
+		memcpy(keys, sort.keys, sizeof(uint64_t) * count);
+		if (values != NULL)
+		{
+			memcpy(values, sort.values, sizeof(int) * count);
+		}
+	}
+	free(tasks);
+	free(sort.histograms);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef RADIX_SORT_H
+#define  RADIX_SORT_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	RADIX_BITS	8
+#define	RADIX_BUCKETS	(1 << RADIX_BITS)
+
+/* Below this many keys a single thread sorts faster than the pool can start */
+#define	RADIX_PARALLEL_MIN	(1 << 20)
+
+/* Map a signed coordinate to an unsigned key of the same order */
+#define	RADIX_COORDINATE_KEY(value)	((uint64_t)(uint32_t)(value) ^ 0x80000000ULL)
+
+/* Type Definitions */
+
+/* One sort shared by the workers, every worker owns a contiguous chunk of the keys */
+typedef struct radixSort
+{
+	uint64_t *keys;
+	int *values;
+	uint64_t *keyBuffer;
+	int *valueBuffer;
+	size_t count;
+	int numberOfChunks;
+	int shift;
+
+	/* Count of every digit in every chunk, then where the chunk writes its next key of that digit */
+	size_t *histograms;
+} RadixSort;
+
+/* Functions */
+void RadixSortKeys(uint64_t *keys, int *values, uint64_t *keyBuffer, int *valueBuffer, size_t count, int numberOfWorkers);
+
+#endif
@@ -43,113 +43,404 @@
 * This will usually yield a reduced set of lines separating all the points.
 */
 
-#include "SeparatingLines.h">
+#include "SeparatingLines.h"
+#include "InstanceParser.h"
+#include "BinaryFormat.h"
+#include "MaxGainGreedy.h"
+#include "LocalOptimization.h"
+#include "MultiStart.h"
+#include "AnytimeSolver.h"
+#include "LowerBounds.h"
+#include "ExactSolver.h"
+#include "SolutionVerifier.h"
+#include "SpatialDecomposition.h"
+#include "IncrementalSolver.h"
+#include "PointLocation.h"
+#include "RadixSort.h"
+#include "WorkPool.h"
+
+/* Round the size up to the arena alignment */
+size_t ArenaAlignUp(size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
 
-int SortByXValue(const void *ptr1, const void *ptr2)
+/* Chain a new block of at least the given capacity in front of the current one */
+ArenaBlock *ArenaAddBlock(Arena *arena, size_t capacity)
 {
-	_2DPoint **p1 = (_2DPoint **)ptr1;
-	_2DPoint **p2 = (_2DPoint **)ptr2;
+	ArenaBlock *block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + capacity + ARENA_ALIGNMENT);
+	if (block == NULL)
+	{
+		return (NULL);
+	}
+	block->base = (char *)ArenaAlignUp((size_t)(uintptr_t)(block + 1));
+	block->capacity = capacity;
+	block->used = 0;
+	block->previous = arena->current;
+	arena->current = block;
+	arena->totalCapacity += capacity;
+	return (block);
+}
 
-	if ((*p1)->xValue > (*p2)->xValue) 
+/* Carve an aligned chunk out of the arena, a new block is chained only when the current one is full */
+void *ArenaAlloc(Arena *arena, size_t size)
+{
+	ArenaBlock *block = arena->current;
+	size = ArenaAlignUp(size);
+	if (block == NULL || block->capacity - block->used < size)
 	{
-		return (1);
+		size_t capacity = ARENA_MIN_BLOCK;
+		if (capacity < arena->totalCapacity)
+		{
+			capacity = arena->totalCapacity;
+		}
+		if (capacity < size)
+		{
+			capacity = size;
+		}
+		block = ArenaAddBlock(arena, capacity);
+		if (block == NULL)
+		{
+			ReportOutOfMemory(size);
+		}
 	}
+	void *chunk = block->base + block->used;
+	block->used += size;
+	arena->allocatedBytes += size;
+	return (chunk);
+}
+
+/* Quit with the out of memory message, the solver cannot go on without the storage */
+void ReportOutOfMemory(size_t size)
+{
+	(void)fprintf(stderr, OUT_OF_MEMORY_ERR, (unsigned long)size);
+	exit(EXIT_FAILURE);
+}
 
-	if ((*p1)->xValue < (*p2)->xValue) {
-		return (-1);
+/* Allocate storage that lives outside the arena */
+void *AllocateStorage(size_t size)
+{
+	void *memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL)
+	{
+		ReportOutOfMemory(size);
 	}
+	return (memory);
+}
 
-	return (0);
+/* Allocate zeroed storage for count items of the given size */
+void *AllocateClearedStorage(size_t count, size_t size)
+{
+	void *memory = calloc(count > 0 ? count : 1, size > 0 ? size : 1);
+	if (memory == NULL)
+	{
+		ReportOutOfMemory(count * size);
+	}
+	return (memory);
+}
 
+/* Resize storage allocated outside the arena, the old block stays valid until the new one exists */
+void *ResizeStorage(void *memory, size_t size)
+{
+	void *resized = realloc(memory, size > 0 ? size : 1);
+	if (resized == NULL)
+	{
+		ReportOutOfMemory(size);
+	}
+	return (resized);
 }
 
-int SortByYValue(const void *ptr1, const void *ptr2)
+/* Remember the current position of the arena */
+ArenaMark ArenaGetMark(const Arena *arena)
 {
-	_2DPoint **p1 = (_2DPoint **)ptr1;
-	_2DPoint **p2 = (_2DPoint **)ptr2;
+	ArenaMark mark;
+	mark.block = arena->current;
+	mark.used = arena->current != NULL ? arena->current->used : 0;
+	mark.allocatedBytes = arena->allocatedBytes;
+	return (mark);
+}
 
-	if ((*p1)->yValue > (*p2)->yValue) 
+/* Hand back everything carved since the mark. When a block was chained in between,
+ * only the newest one is emptied, the next reset coalesces the blocks anyway
+ */
+void ArenaRewind(Arena *arena, const ArenaMark *mark)
+{
+	arena->allocatedBytes = mark->allocatedBytes;
+	if (arena->current == NULL)
 	{
-		return (1);
+		return;
 	}
+	arena->current->used = arena->current == mark->block ? mark->used : 0;
+}
 
-	if ((*p1)->yValue < (*p2)->yValue) {
-		return (-1);
+/* Release every block of the arena back to the system */
+void ArenaFree(Arena *arena)
+{
+	while (arena->current != NULL)
+	{
+		ArenaBlock *previous = arena->current->previous;
+		free(arena->current);
+		arena->current = previous;
 	}
+	arena->totalCapacity = 0;
+}
 
-	return (0);
+/* Make the whole arena available again. If the last instance needed more than one
+ * block, they are coalesced into a single one so that the next instance of the
+ * same size is carved without touching malloc
+ */
+void ArenaReset(Arena *arena)
+{
+	arena->allocatedBytes = 0;
+	if (arena->current == NULL)
+	{
+		return;
+	}
+	if (arena->current->previous != NULL)
+	{
+		size_t capacity = arena->totalCapacity;
+		ArenaFree(arena);
+		if (ArenaAddBlock(arena, capacity) == NULL)
+		{
+			return;
+		}
+	}
+	arena->current->used = 0;
 }
 
-void SortInputPoints()
+/* Prepare an empty solver, no storage is allocated until an instance is read */
+void InitializeSolver(Solver *solver, const Options *options)
 {
-	qsort(mySortedXPoints, myNumberOfPoints, sizeof(_2DPoint *), &SortByXValue);
-	qsort(mySortedYPoints, myNumberOfPoints, sizeof(_2DPoint *), &SortByYValue);
+	memset(solver, 0, sizeof(Solver));
+	solver->myEngine = options->engine;
+	solver->myGreedy = options->greedy;
+	solver->myLocalSearch = options->isLocalSearch;
+	solver->myEarlyExit = options->isEarlyExit;
+	solver->myNumberOfRestarts = options->numberOfRestarts;
+	solver->mySeed = options->seed;
+	solver->myTimeLimit = options->timeLimit;
+	solver->myExact = options->isExact;
+	solver->myNumberOfParts = options->numberOfParts;
+	solver->myOptionsError = CheckOptions(options);
+
+	/* a batch already keeps every core busy, its restarts run one after the other */
+	solver->myRestartWorkers = options->isBatch ? 1 : 0;
 }
 
-/* Initialize all the points with connections to other points, number of connections */
-void InitializePoints()
+/* Release all the storage owned by the solver */
+void FreeSolver(Solver *solver)
+{
+	ArenaFree(&solver->myArena);
+}
+
+/* Initialize an empty solver with the settings of another one. The copy is meant to
+ * run on a worker of a pool, so it sorts on a single thread
+ */
+void CopySolverSettings(Solver *solver, const Solver *source)
+{
+	memset(solver, 0, sizeof(Solver));
+	solver->myEngine = source->myEngine;
+	solver->myGreedy = source->myGreedy;
+	solver->myLocalSearch = source->myLocalSearch;
+	solver->myEarlyExit = source->myEarlyExit;
+	solver->myNumberOfRestarts = source->myNumberOfRestarts;
+	solver->myRestartWorkers = 1;
+	solver->mySeed = source->mySeed;
+	solver->myTimeLimit = source->myTimeLimit;
+	solver->myExact = source->myExact;
+	solver->myNumberOfParts = source->myNumberOfParts;
+}
+
+/* Load the points of the instance held by another solver into an empty solver */
+void CopyInstance(Solver *solver, const Solver *source)
+{
+	int numberOfPoints = source->myNumberOfPoints;
+	solver->myNumberOfPoints = numberOfPoints;
+	AllocateSolverStorage(solver, numberOfPoints);
+	memcpy(solver->myValues[X], source->myValues[X], sizeof(int) * (size_t)numberOfPoints);
+	memcpy(solver->myValues[Y], source->myValues[Y], sizeof(int) * (size_t)numberOfPoints);
+}
+
+/* Size every solver array from the number of points announced in the instance header */
+void AllocateSolverStorage(Solver *solver, int numberOfPoints)
+{
+	size_t n = (size_t)numberOfPoints;
+	int axis = X;
+	while (axis <= Y)
+	{
+		solver->myValues[axis] = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+		solver->myRanks[axis] = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+		solver->mySortedIds[axis] = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+		solver->mySortedValues[axis] = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+		solver->myOtherRanks[axis] = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+		axis++;
+	}
+	solver->myXAxisLines = (Line *)ArenaAlloc(&solver->myArena, sizeof(Line) * n);
+	solver->myYAxisLines = (Line *)ArenaAlloc(&solver->myArena, sizeof(Line) * n);
+	solver->myCommittedLines = (Line **)ArenaAlloc(&solver->myArena, sizeof(Line *) * 2 * n);
+	solver->myLineAtGap[X] = (Line **)ArenaAlloc(&solver->myArena, sizeof(Line *) * n);
+	solver->myLineAtGap[Y] = (Line **)ArenaAlloc(&solver->myArena, sizeof(Line *) * n);
+	solver->myGapPrefix = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	solver->myBandMark = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+}
+
+/* Sort the ids of one axis with the coordinates as radix keys, the sort is stable so
+ * equal coordinates keep the input order
+ */
+void SortAxisPoints(Solver *solver, int axis, uint64_t *keys, uint64_t *keyBuffer, int *idBuffer)
 {
+	const int *values = solver->myValues[axis];
+	int *ids = solver->mySortedIds[axis];
 	int index = 0;
-	while (index < myNumberOfPoints) 
+	while (index < solver->myNumberOfPoints)
 	{
-		my2DPoints[index].pointerToConnectedPoints = (_2DPoint**)malloc(sizeof(_2DPoint *)*MAX_PTS);
+		keys[index] = RADIX_COORDINATE_KEY(values[index]);
+		ids[index] = index;
 		index++;
 	}
-	index = 0;
-	while (index < myNumberOfPoints) 
+	int numberOfWorkers = solver->myRestartWorkers > 0 ? solver->myRestartWorkers : GetNumberOfCores();
+	RadixSortKeys(keys, ids, keyBuffer, idBuffer, (size_t)solver->myNumberOfPoints, numberOfWorkers);
+	int rank = 0;
+	while (rank < solver->myNumberOfPoints)
 	{
-		int j = 0;
-		my2DPoints[index].id = index;
-		while (j < myNumberOfPoints) 
-		{
-			if (index != j) 
-			{
-				my2DPoints[index].pointerToConnectedPoints[j] = &(my2DPoints[j]);
-				my2DPoints[index].numberOfConnections++;
-				myRemainingConnections++;
-			}
-			else 
-			{
-				my2DPoints[index].pointerToConnectedPoints[j] = NULL;
-			}
-			j++;
-		}
-		index++;
+		solver->mySortedValues[axis][rank] = values[ids[rank]];
+		solver->myRanks[axis][ids[rank]] = rank;
+		rank++;
 	}
-	if (myRemainingConnections != myNumberOfPoints*(myNumberOfPoints - 1)) 
+}
+
+/* Sort the points along both axes and compress the coordinates to their ranks */
+void SortInputPoints(Solver *solver)
+{
+	size_t n = (size_t)solver->myNumberOfPoints;
+	ArenaMark mark = ArenaGetMark(&solver->myArena);
+	uint64_t *keys = (uint64_t *)ArenaAlloc(&solver->myArena, sizeof(uint64_t) * 2 * (n + 1));
+	int *idBuffer = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * (n + 1));
+	SortAxisPoints(solver, X, keys, keys + n + 1, idBuffer);
+	SortAxisPoints(solver, Y, keys, keys + n + 1, idBuffer);
+	ArenaRewind(&solver->myArena, &mark);
+
+	int rank = 0;
+	while (rank < solver->myNumberOfPoints)
 	{
-		printf("Number of Connections=%d, but should be %d\n", myRemainingConnections, myNumberOfPoints*(myNumberOfPoints - 1));
-		exit(0);
+		solver->myOtherRanks[X][rank] = solver->myRanks[Y][solver->mySortedIds[X][rank]];
+		solver->myOtherRanks[Y][rank] = solver->myRanks[X][solver->mySortedIds[Y][rank]];
+		rank++;
 	}
+}
 
+/* Put every point in a single cell, the cell engine needs no connection matrix */
+void InitializeCells(Solver *solver)
+{
+	size_t n = (size_t)solver->myNumberOfPoints;
+	solver->myCellOfPoint = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	solver->myCellSize = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	solver->myCellMark = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	solver->myCellSplitMark = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	solver->myCellSplit = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+	memset(solver->myCellMark, 0, sizeof(int) * n);
+	memset(solver->myCellSplitMark, 0, sizeof(int) * n);
+	solver->myCellEpoch = 0;
+
+	memset(solver->myCellOfPoint, 0, sizeof(int) * n);
+	solver->myCellSize[0] = solver->myNumberOfPoints;
+	solver->myNumberOfCells = 1;
 }
 
-void FreeConnections()
+/* Allocate the committed gap bitsets of both axes, sized like the connection rows */
+void InitializeCommittedGaps(Solver *solver)
 {
-	int i = 0;
-	while (i < myNumberOfPoints) 
+	size_t n = (size_t)solver->myNumberOfPoints;
+	size_t rowWords = (n + CONNECTION_WORD_BITS - 1) / CONNECTION_WORD_BITS;
+	rowWords = (rowWords + CONNECTION_ROW_ALIGN_WORDS - 1) / CONNECTION_ROW_ALIGN_WORDS * CONNECTION_ROW_ALIGN_WORDS;
+	solver->myConnectionRowWords = rowWords;
+	solver->myCommittedGaps[X] = (ConnectionWord *)ArenaAlloc(&solver->myArena, sizeof(ConnectionWord) * rowWords);
+	solver->myCommittedGaps[Y] = (ConnectionWord *)ArenaAlloc(&solver->myArena, sizeof(ConnectionWord) * rowWords);
+	memset(solver->myCommittedGaps[X], 0, sizeof(ConnectionWord) * rowWords);
+	memset(solver->myCommittedGaps[Y], 0, sizeof(ConnectionWord) * rowWords);
+}
+
+/* Initialize all the points with connections to other points, number of connections */
+void InitializePoints(Solver *solver)
+{
+	size_t n = (size_t)solver->myNumberOfPoints;
+	InitializeCommittedGaps(solver);
+	size_t rowWords = solver->myConnectionRowWords;
+	solver->myRemainingConnections = (long long)solver->myNumberOfPoints*(solver->myNumberOfPoints - 1);
+
+	if (solver->myEngine == CELL_ENGINE)
 	{
-		free(my2DPoints[i].pointerToConnectedPoints);
-		i++;
+		InitializeCells(solver);
+		return;
+	}
+
+	solver->myConnections = (ConnectionWord *)ArenaAlloc(&solver->myArena, sizeof(ConnectionWord) * rowWords * n);
+	solver->myLineMask = (ConnectionWord *)ArenaAlloc(&solver->myArena, sizeof(ConnectionWord) * rowWords);
+	solver->myNumberOfConnections = (int *)ArenaAlloc(&solver->myArena, sizeof(int) * n);
+
+	/* every row is all ones over the n points, the padding bits stay clear */
+	size_t fullWords = n / CONNECTION_WORD_BITS;
+	ConnectionWord tail = 0;
+	if (n % CONNECTION_WORD_BITS)
+	{
+		tail = ((ConnectionWord)1 << (n % CONNECTION_WORD_BITS)) - 1;
+	}
+	int index = 0;
+	while (index < solver->myNumberOfPoints) 
+	{
+		ConnectionWord *row = solver->myConnections + (size_t)index * rowWords;
+		size_t w = 0;
+		while (w < rowWords)
+		{
+			row[w] = w < fullWords ? ~(ConnectionWord)0 : (w == fullWords ? tail : 0);
+			w++;
+		}
+
+		/* a point is not connected to itself */
+		row[index / CONNECTION_WORD_BITS] &= ~((ConnectionWord)1 << (index % CONNECTION_WORD_BITS));
+		solver->myNumberOfConnections[index] = solver->myNumberOfPoints - 1;
+		index++;
 	}
-	myNumberOfPoints = 0;
-	myNumberOfLines = 0;
-	myNumberOfLinesInXAxis = 0;
-	myNumberOfLinesInYAxis = 0;
 }
 
-/* Write the committed line details to the output file */
-void WriteOutputFile(char* fileName)
-{	
-	char str[255];
-	char *s = &str[0];
-	
+/* Forget the current instance. The storage stays with the arena for the next input file */
+void ResetSolverStorage(Solver *solver)
+{
+	ArenaReset(&solver->myArena);
+	solver->myNumberOfPoints = 0;
+	solver->myNumberOfLines = 0;
+	solver->myNumberOfLinesInXAxis = 0;
+	solver->myNumberOfLinesInYAxis = 0;
+	solver->myRemainingConnections = 0;
+	solver->myIsTimedOut = 0;
+	solver->myIsFinished = 0;
+	memset(&solver->myStats, 0, sizeof(SolverStats));
+}
+
+/* Get twice the coordinate of the line, i.e. the sum of the two points around its gap.
+ * Lines lie halfway between integer coordinates, so this is exact
+ */
+long long GetDoubledIntersectionValue(Solver *solver, Line *l)
+{
+	const int *values = solver->mySortedValues[l->lineAxis];
+	return ((long long)values[l->leftRank] + values[l->leftRank + 1]);
+}
+
+/* Get the coordinate of the line, the exact midpoint of the two points around its gap */
+double GetIntersectionValue(Solver *solver, Line *l)
+{
+	return ((double)GetDoubledIntersectionValue(solver, l) / 2);
+}
+
+/* Get the name of the solution file of an instance, greedy_solution followed by the digits of the instance name */
+void GetSolutionFileName(char *fileName, char *solutionName, const char *suffix)
+{
 	char instanceNumberString[10];
 	int j = 0;
 	int startIndex = 0;
 	while(fileName[j] != '\0')
 	{
-		if(isdigit(fileName[j]))
+		if(isdigit(fileName[j]) && startIndex < (int)sizeof(instanceNumberString) - 1)
 		{
 			instanceNumberString[startIndex++] = fileName[j];
 		}
@@ -158,25 +449,49 @@ void WriteOutputFile(char* fileName)
 	instanceNumberString[startIndex] = '\0';
 	int instanceNumber = atoi(instanceNumberString);
 
-	sprintf(s, "greedy_solution%.2d", instanceNumber);
-	FILE *out = fopen(s, "w");
-	int i = 0;
+	sprintf(solutionName, "greedy_solution%.2d%s", instanceNumber, suffix);
+}
+
+/* Get the number of lines still committed */
+int CountCommittedLines(Solver *solver)
+{
 	int totalCommittedLines = 0;
-	for(int index = 0; index < myNumberOfLines; index++)
+	for(int index = 0; index < solver->myNumberOfLines; index++)
 	{
-		if (myCommittedLines[index]->isCommitted)
+		if (solver->myCommittedLines[index]->isCommitted)
 			totalCommittedLines++;
 	}
-	fprintf(out, "%d\n", totalCommittedLines);
+	return (totalCommittedLines);
+}
+
+/* Write the committed line details to the output file */
+void WriteOutputFile(Solver *solver, char* fileName)
+{	
+	char str[255];
+	char *s = &str[0];
+	GetSolutionFileName(fileName, s, "");
+	WriteSolutionFile(solver, s);
+}
+
+/* Write the committed lines in the text format to the given solution file */
+void WriteSolutionFile(Solver *solver, const char *solutionName)
+{
+	FILE *out = fopen(solutionName, "w");
+	if (out == NULL)
+	{
+		return;
+	}
+	int i = 0;
+	fprintf(out, "%d\n", CountCommittedLines(solver));
 	
-	while (i < myNumberOfLines) 
+	while (i < solver->myNumberOfLines) 
 	{
-		if(!myCommittedLines[i]->isCommitted)
+		if(!solver->myCommittedLines[i]->isCommitted)
 		{
 			i++;
 			continue;
 		}
-		switch (myCommittedLines[i]->lineAxis) {
+		switch (solver->myCommittedLines[i]->lineAxis) {
 
 		case X:
 			(void)fprintf(out, "v ");
@@ -187,606 +502,645 @@ void WriteOutputFile(char* fileName)
 			break;
 		default: break;
 		}
-		(void)fprintf(out, "%f\n", myCommittedLines[i]->intersectionValue);
+		(void)fprintf(out, "%f\n", GetIntersectionValue(solver, solver->myCommittedLines[i]));
 		i++;
 	}
 	fclose(out);
 }
 
-/* Get the nearest point to the input intersection value */
-int GetNearestPointToTheIntersection(int axis, float inter)
+/* Write the solution in the format chosen on the command line */
+void WriteSolution(Solver *solver, char *fileName, const Options *options)
 {
-	_2DPoint **points;
-	if (axis == X) 
+	STATS_START(timer);
+	if (options->isBinaryOutput)
 	{
-		points = mySortedXPoints;
+		WriteBinarySolution(solver, fileName);
 	}
-	else 
+	else
 	{
-		points = mySortedYPoints;
+		WriteOutputFile(solver, fileName);
 	}
+	STATS_LAP(solver, WRITE_PHASE, timer);
+}
 
-	int i = 0;
-	float value;
-	while (i < myNumberOfPoints) 
+/* Get the nearest point to the input intersection value, i.e. the rank of the last point
+ * at or before the intersection along the axis, -1 if every point lies after it.
+ * Used to place lines given by a real coordinate
+ */
+int GetNearestPointToTheIntersection(Solver *solver, int axis, double inter)
+{
+	const int *values = solver->mySortedValues[axis];
+
+	/* binary search for the first point after the intersection */
+	int low = 0;
+	int high = solver->myNumberOfPoints;
+	while (low < high) 
 	{
-		if (axis == X) 
+		int mid = low + (high - low) / 2;
+		if ((double)values[mid] > inter) 
 		{
-			value = (float)points[i]->xValue;
+			high = mid;
 		}
 		else 
 		{
-			value = (float)points[i]->yValue;
-		}
-
-		if ((float)value > inter) 
-		{
-			return i - 1;
+			low = mid + 1;
 		}
-
-		i++;
 	}
 
-	return (-1);
+	return (low - 1);
 }
 
-/* Disconnect the two points by removing connection and update the remaining connection count*/
-void DisconnectPoints(int point1, int point2)
+/* Set the line mask to the ids of the points ls[from..to] */
+void BuildLineMask(Solver *solver, const int *ls, int from, int to)
 {
-	if (my2DPoints[point1].pointerToConnectedPoints[point2] != NULL)
+	memset(solver->myLineMask, 0, sizeof(ConnectionWord) * solver->myConnectionRowWords);
+	while (from <= to)
 	{
-		my2DPoints[point1].pointerToConnectedPoints[point2] = NULL;
-		my2DPoints[point1].numberOfConnections--;
-
-		my2DPoints[point2].pointerToConnectedPoints[point1] = NULL;
-		my2DPoints[point2].numberOfConnections--;
+		int id = ls[from];
+		solver->myLineMask[id / CONNECTION_WORD_BITS] |= (ConnectionWord)1 << (id % CONNECTION_WORD_BITS);
+		from++;
+	}
+}
 
-		myRemainingConnections -= 2;
+/* Remove the connections between the points ls[from..to] and the points in the line mask,
+ * returns the number of connections removed from these rows
+ */
+long long DisconnectRows(Solver *solver, const int *ls, int from, int to)
+{
+	long long removed = 0;
+	size_t rowWords = solver->myConnectionRowWords;
+	const ConnectionWord *mask = solver->myLineMask;
+	while (from <= to)
+	{
+		int id = ls[from];
+		ConnectionWord *row = solver->myConnections + (size_t)id * rowWords;
+		int cleared = 0;
+		size_t w = 0;
+		while (w < rowWords)
+		{
+			cleared += __builtin_popcountll(row[w] & mask[w]);
+			row[w] &= ~mask[w];
+			w++;
+		}
+		solver->myNumberOfConnections[id] -= cleared;
+		removed += cleared;
+		STATS_ADD(solver, disconnectCalls, 1);
+		from++;
 	}
+	return (removed);
 }
 
-/* Commit the line and remove connection of points across the line */
-void CommitLine(Line *l)
+/* Get the closest committed gap below the gap on the axis, -1 if there is none */
+int PreviousCommittedGap(Solver *solver, int axis, int gap)
 {
-	l->isCommitted = 1;
-	_2DPoint **ls;
-	int axis = l->lineAxis;
-	float inter = (float)l->intersectionValue;
-	myCommittedLines[myNumberOfLines] = l;
-	int p = GetNearestPointToTheIntersection(axis, inter);
-	if (axis == X) {
-		ls = mySortedXPoints;
+	const ConnectionWord *gaps = solver->myCommittedGaps[axis];
+	int w = gap / CONNECTION_WORD_BITS;
+	ConnectionWord word = gaps[w] & (((ConnectionWord)1 << (gap % CONNECTION_WORD_BITS)) - 1);
+	while (!word)
+	{
+		if (--w < 0)
+		{
+			return (-1);
+		}
+		word = gaps[w];
 	}
-	else {
-		ls = mySortedYPoints;
+	return (w * CONNECTION_WORD_BITS + CONNECTION_WORD_BITS - 1 - __builtin_clzll(word));
+}
+
+/* Get the closest committed gap above the gap on the axis, the last rank if there is none */
+int NextCommittedGap(Solver *solver, int axis, int gap)
+{
+	const ConnectionWord *gaps = solver->myCommittedGaps[axis];
+	int words = (solver->myNumberOfPoints + CONNECTION_WORD_BITS - 1) / CONNECTION_WORD_BITS;
+	int w = (gap + 1) / CONNECTION_WORD_BITS;
+	ConnectionWord word = 0;
+	if (w < words)
+	{
+		word = gaps[w] & (~(ConnectionWord)0 << ((gap + 1) % CONNECTION_WORD_BITS));
 	}
-	int i = 0;
-	int j;
-	while (i <= p) {
-		j = p + 1;
-		while (j < myNumberOfPoints) {
-			DisconnectPoints(ls[i]->id,
-				ls[j]->id);
-			j++;
+	while (!word)
+	{
+		if (++w >= words)
+		{
+			return (solver->myNumberOfPoints - 1);
 		}
-		i++;
+		word = gaps[w];
 	}
-	myNumberOfLines++;
+	int next = w * CONNECTION_WORD_BITS + __builtin_ctzll(word);
+	return (next < solver->myNumberOfPoints - 1 ? next : solver->myNumberOfPoints - 1);
 }
 
-/* Add lines between every point such that it separates every point from any other point */
-void AddLines(int axis, int from, int to)
+/* Mark the cells of the points ls[from..to] with a fresh epoch */
+void MarkCells(Solver *solver, const int *ls, int from, int to)
 {
-	if (from == to) 
+	solver->myCellEpoch++;
+	while (from <= to)
 	{
-		return;
+		solver->myCellMark[solver->myCellOfPoint[ls[from]]] = solver->myCellEpoch;
+		from++;
 	}
+}
 
-	int span;
-	int half;
-	float pta;
-	float ptb;
-	_2DPoint *pt1;
-	_2DPoint *pt2;
-	float ptdiff;
-	float ptmid_dist;
-	float ptmid_coord;
-	Line *cur_ln;
-	_2DPoint **ls;
-	if (axis == X) 
+/* Only the points of the slab between the neighbouring committed lines can share a cell
+ * with a point on the other side of the line at gap p, so the cell engine looks at that slab alone.
+ * Returns 1 if a cell of the slab has points on both sides of the line
+ */
+int CheckCellConnection(Solver *solver, int axis, const int *ls, int p)
+{
+	int from = PreviousCommittedGap(solver, axis, p) + 1;
+	int to = NextCommittedGap(solver, axis, p);
+	MarkCells(solver, ls, from, p);
+	int i = p + 1;
+	while (i <= to)
 	{
-		ls = &(mySortedXPoints[0]);
+		if (solver->myCellMark[solver->myCellOfPoint[ls[i]]] == solver->myCellEpoch)
+		{
+			STATS_ADD(solver, pointsInspected, i - from + 1);
+			return (1);
+		}
+		i++;
 	}
-	else
+	STATS_ADD(solver, pointsInspected, to - from + 1);
+	return (0);
+}
+
+/* Split every cell of the slab that straddles the line at gap p, the points on the
+ * right side of a straddling cell move to a new cell
+ */
+void CommitCellLine(Solver *solver, int axis, const int *ls, int p)
+{
+	int from = PreviousCommittedGap(solver, axis, p) + 1;
+	int to = NextCommittedGap(solver, axis, p);
+	MarkCells(solver, ls, from, p);
+	int i = p + 1;
+	while (i <= to)
 	{
-		ls = &(mySortedYPoints[0]);
+		int id = ls[i];
+		int cell = solver->myCellOfPoint[id];
+		if (solver->myCellMark[cell] == solver->myCellEpoch)
+		{
+			if (solver->myCellSplitMark[cell] != solver->myCellEpoch)
+			{
+				solver->myCellSplitMark[cell] = solver->myCellEpoch;
+				solver->myCellSplit[cell] = solver->myNumberOfCells;
+				solver->myCellSize[solver->myNumberOfCells] = 0;
+				solver->myNumberOfCells++;
+			}
+			int split = solver->myCellSplit[cell];
+
+			/* the point loses its connections in the old cell and keeps the ones in the new cell */
+			solver->myRemainingConnections -= 2 * (long long)(solver->myCellSize[cell] - 1 - solver->myCellSize[split]);
+			solver->myCellSize[cell]--;
+			solver->myCellSize[split]++;
+			solver->myCellOfPoint[id] = split;
+			STATS_ADD(solver, pointsMoved, 1);
+		}
+		i++;
 	}
-	span = to - from;
-	if (span == 0) 
-	{
+}
+
+/* Commit the line and remove connection of points across the line */
+void CommitLine(Solver *solver, Line *l)
+{
+	l->isCommitted = 1;
+	int axis = l->lineAxis;
+	const int *ls = solver->mySortedIds[axis];
+	solver->myCommittedLines[solver->myNumberOfLines] = l;
+	int p = l->leftRank;
+	solver->myNumberOfLines++;
+	STATS_ADD(solver, linesCommitted, 1);
+	if (p < 0 || p >= solver->myNumberOfPoints - 1) {
+		return;
+	}
+	solver->myCommittedGaps[axis][p / CONNECTION_WORD_BITS] |= (ConnectionWord)1 << (p % CONNECTION_WORD_BITS);
+	if (solver->myEngine == CELL_ENGINE) {
+		CommitCellLine(solver, axis, ls, p);
 		return;
 	}
 
-	half = (to + from) / 2;
-	
-	pt1 = ls[half];
-	pt2 = ls[half + 1];
-	if (axis == X)
+	/* clear the right side out of the left rows, then the left side out of the right rows */
+	BuildLineMask(solver, ls, p + 1, solver->myNumberOfPoints - 1);
+	solver->myRemainingConnections -= DisconnectRows(solver, ls, 0, p);
+	BuildLineMask(solver, ls, 0, p);
+	solver->myRemainingConnections -= DisconnectRows(solver, ls, p + 1, solver->myNumberOfPoints - 1);
+}
+
+/* Add lines between every point such that it separates every point from any other point */
+void AddLines(Solver *solver, int axis, int from, int to)
+{
+	if (from >= to) 
 	{
-		pta = (float)pt1->xValue;
-		ptb = (float)pt2->xValue;
+		return;
 	}
-	else
+
+	int half = (to + from) / 2;
+	if (solver->myIsRandomized)
 	{
-		pta = (float)pt1->yValue;
-		ptb = (float)pt2->yValue;
+		/* a random rank of the middle half keeps the recursion shallow */
+		int span = to - from;
+		half = from + span / 4 + (int)(NextRandom(&solver->myRandomState) % (unsigned long long)(span / 2 + 1));
 	}
-	ptdiff = ptb - pta;
-	ptmid_dist = ptdiff / 2;
-	ptmid_coord = pta + ptmid_dist;
-		
+	Line *cur_ln;
 	if (axis == X)
 	{
-		cur_ln = &myXAxisLines[myNumberOfLinesInXAxis];
-		cur_ln->lineAxis = X;
-		myNumberOfLinesInXAxis++;
+		cur_ln = &solver->myXAxisLines[solver->myNumberOfLinesInXAxis];
+		solver->myNumberOfLinesInXAxis++;
 	}
 	else
 	{
-		cur_ln = &myYAxisLines[myNumberOfLinesInYAxis];
-		cur_ln->lineAxis = Y;
-		myNumberOfLinesInYAxis++;
+		cur_ln = &solver->myYAxisLines[solver->myNumberOfLinesInYAxis];
+		solver->myNumberOfLinesInYAxis++;
 	}
-	cur_ln->intersectionValue = ptmid_coord;
+
+	/* the line lies between the points of rank half and half + 1 */
+	cur_ln->lineAxis = axis;
+	cur_ln->leftRank = half;
 	cur_ln->isCommitted = 0;
 		
-	AddLines(axis, from, half);
-	AddLines(axis, half + 1, to);
+	AddLines(solver, axis, from, half);
+	AddLines(solver, axis, half + 1, to);
 }
 
 /* Check if the points on either side of the line separates are alreday disconnected 
  * If any of the points still are connected across the line, committ the line
  * Else do not committ the line 
  */
-int CheckConnection(Line *ln)
+int CheckConnection(Solver *solver, Line *ln)
 {
 	int axis = ln->lineAxis;
-	float inter = ln->intersectionValue;
 
 	/* get the immediate points to the left of the line ln based on the line axis */
-	int p = GetNearestPointToTheIntersection(axis, inter);
-	_2DPoint **ls;
+	int p = ln->leftRank;
+	const int *ls = solver->mySortedIds[axis];
+	STATS_ADD(solver, checkConnectionCalls, 1);
 
-	if (axis == X) {
-		ls = &(mySortedXPoints[0]);
+	if (p < 0 || p >= solver->myNumberOfPoints - 1) {
+		return (0);
 	}
-	else {
-		ls = &(mySortedYPoints[0]);
+	if (solver->myEngine == CELL_ENGINE) {
+		return (CheckCellConnection(solver, axis, ls, p));
 	}
 
-	/* Check if any point is connected to any other point across the line */
-	int i = 0;
-	int j;
-	while (i < (p + 1)) {
-		j = p + 1;
-		while (j < myNumberOfPoints) {
-			if ((my2DPoints[(ls[i]->id)].
-				pointerToConnectedPoints[(ls[j]->id)]) != NULL) {
-				return (1);
-			}
-			j++;
-		}
-		i++;
+	/* The matrix is symmetric, so test the rows of the smaller side against a mask of the other side */
+	int from = 0;
+	int to = p;
+	if (p + 1 > solver->myNumberOfPoints - p - 1)
+	{
+		BuildLineMask(solver, ls, 0, p);
+		from = p + 1;
+		to = solver->myNumberOfPoints - 1;
 	}
-	return (0);
-}
-
-int SortByIntersectionValue(const void *ptr1, const void *ptr2)
-{
-	Line *p1 = (Line *)ptr1;
-	Line *p2 = (Line *)ptr2;
-
-	if ((*p1).intersectionValue > (*p2).intersectionValue) {
-		return (1);
+	else
+	{
+		BuildLineMask(solver, ls, p + 1, solver->myNumberOfPoints - 1);
 	}
 
-	if ((*p1).intersectionValue < (*p2).intersectionValue) {
-		return (-1);
+	/* Check if any point is connected to any other point across the line */
+	size_t rowWords = solver->myConnectionRowWords;
+	const ConnectionWord *mask = solver->myLineMask;
+	while (from <= to) {
+		const ConnectionWord *row = solver->myConnections + (size_t)ls[from] * rowWords;
+		ConnectionWord any = 0;
+		size_t w = 0;
+		while (w < rowWords) {
+			any |= row[w] & mask[w];
+			w++;
+		}
+		STATS_ADD(solver, pairsInspected, to == p ? solver->myNumberOfPoints - p - 1 : p + 1);
+		if (any) {
+			return (1);
+		}
+		from++;
 	}
-
 	return (0);
 }
 
-int CompareYValue(const void *ptr1, const void *ptr2)
+/* Check if any line of the axis can be removed such that all the affected points are separated by
+ * any other committed line. Removing the line at gap g merges the slab between the committed lines
+ * around it, so the line is redundant when no two points of the merged slab fall in the same band
+ * of the other axis. Lines are visited in order and a run of removed lines keeps growing the same
+ * merged slab, so every point is looked at a bounded number of times. Returns the number of lines removed
+ */
+int RemoveRedundantLines(Solver *solver, int axis)
 {
-	_2DPoint *p1 = (_2DPoint *)ptr1;
-	_2DPoint *p2 = (_2DPoint *)ptr2;
-
-	if ((*p1).yValue > (*p2).yValue) {
-		return (1);
-	}
-
-	if ((*p1).yValue < (*p2).yValue) {
-		return (-1);
+	int other = axis == X ? Y : X;
+	const int *otherRanks = solver->myOtherRanks[axis];
+	int removed = 0;
+
+	/* the band of a point along the other axis is the number of committed gaps below its rank */
+	int rank = 0;
+	int band = 0;
+	while (rank < solver->myNumberOfPoints)
+	{
+		solver->myGapPrefix[rank] = band;
+		if (rank < solver->myNumberOfPoints - 1 && (solver->myCommittedGaps[other][rank / CONNECTION_WORD_BITS] >> (rank % CONNECTION_WORD_BITS) & 1))
+		{
+			band++;
+		}
+		rank++;
 	}
 
-	return (0);
-}
-
-/* Check if any vertical lines can be removed such that all the affected points are seperated by any other committed line */
-void RemoveRedundantXLines()
-{
-	// check for committed x lines
-	for(int index = 0; index < myCommittedXLineCount; index++)
+	/* the bands of the points of rank previous + 1 .. marked are marked with the current epoch and are all distinct */
+	solver->myBandEpoch++;
+	int marked = -1;
+	int gap = NextCommittedGap(solver, axis, -1);
+	while (gap < solver->myNumberOfPoints - 1)
 	{
-		// x value of the line at the immediate left of the current line considered for validation
-		float leftLineX = 0;
-
-		// x value of the line at the immediate right of the current line considered for validation
-		float rightLineX;
-
-		// List of points in between the immediate left and right line of the current line considered for validation
-		_2DPoint pointsInRange[MAX_PTS];
-		int pointsInRangeCount = 0;
-
-		if(index > 0)
+		int next = NextCommittedGap(solver, axis, gap);
+		int collision = 0;
+		while (marked < next)
 		{
-			int actualLeftIndex = index - 1;
-			if(mySortedXAxislines[actualLeftIndex].isCommitted)
-			{
-				leftLineX = mySortedXAxislines[actualLeftIndex].intersectionValue;
-			}
-			else
+			int *mark = &solver->myBandMark[solver->myGapPrefix[otherRanks[marked + 1]]];
+			if (*mark == solver->myBandEpoch)
 			{
-				while (!mySortedXAxislines[actualLeftIndex].isCommitted)
-				{
-					actualLeftIndex--;
-					if (actualLeftIndex < 0)
-					{
-						leftLineX = 0;
-						break;
-					}
-				}
-				if(actualLeftIndex >= 0 && mySortedXAxislines[actualLeftIndex].isCommitted)
-				{
-					leftLineX = mySortedXAxislines[actualLeftIndex].intersectionValue;
-				}
+				collision = 1;
+				break;
 			}
+			*mark = solver->myBandEpoch;
+			marked++;
 		}
-		if(index == myCommittedXLineCount-1)
+
+		if (collision)
 		{
-			//rightLineX = (*(sorted_x_pt + (n_pts-1)))->pt_x + 1;
-			rightLineX = (*mySortedXPoints[myNumberOfPoints - 1]).xValue + 0.5;
+			/* the line is needed, the next merged slab starts right after it */
+			solver->myBandEpoch++;
+			marked = gap;
 		}
 		else
 		{
-			rightLineX = mySortedXAxislines[index + 1].intersectionValue;
-		}
-		
-		/* get all the points within left and right line */
-		for (int i = 0; i < myNumberOfPoints; i++)
-		{
-			//if((*(sorted_x_pt+i))->pt_x >= leftLineX && (*(sorted_x_pt + i))->pt_x <= rightLineX)
-			if ((*mySortedXPoints[i]).xValue >= leftLineX && (*mySortedXPoints[i]).xValue <= rightLineX)
-			{
-				pointsInRange[pointsInRangeCount++] = **(mySortedXPoints + i);
-				//pointsInRange[pointsInRangeCount++] = *sorted_x_pt[i];
-			}
-		}
-
-		/* sort the points in range by y value */
-		qsort(&pointsInRange, pointsInRangeCount, sizeof(_2DPoint),&CompareYValue);
-
-		int thereExistsALine = 1;
-
-		/* check if any line separates every consecutive points horizontally */
-		for(int i = 0; i < pointsInRangeCount-1; i++)
-		{	
-			int lineExists = 0;
-			int lowerBound = pointsInRange[i].yValue;
-			int upperBound;	
-			
-			upperBound = pointsInRange[i + 1].yValue;
-
-			for (int k = 0; k < myCommittedYLineCount; k++)
-			{
-				if (mySortedYAxislines[k].isCommitted == 1 && lowerBound <= mySortedYAxislines[k].intersectionValue && upperBound >= mySortedYAxislines[k].intersectionValue)
-				{
-					lineExists = 1;
-					break;
-				}
-				lineExists = 0;
-			}
-
-			if (!lineExists)
-			{
-				thereExistsALine = 0;
-				break;
-			}
-		}
-
-		/* If any vertical line separates every consecutive points in range sorted by y value, then uncommitt the current considered ine */
-		if (thereExistsALine)
-		{
-			for (int k = 0; k < myCommittedXLineCount + myCommittedYLineCount; k++)
-			{
-				if (mySortedXAxislines[index].lineAxis == myCommittedLines[k]->lineAxis && mySortedXAxislines[index].intersectionValue == myCommittedLines[k]->intersectionValue)
-				{
-					myCommittedLines[k]->isCommitted = 0;
-					mySortedXAxislines[index].isCommitted = 0;
-				}
-			}
+			solver->myLineAtGap[axis][gap]->isCommitted = 0;
+			solver->myCommittedGaps[axis][gap / CONNECTION_WORD_BITS] &= ~((ConnectionWord)1 << (gap % CONNECTION_WORD_BITS));
+			STATS_ADD(solver, linesUncommitted[axis], 1);
+			removed++;
 		}
+		gap = next;
 	}
+	return (removed);
 }
 
-int CompareXValue(const void *ptr1, const void *ptr2)
+/* Optimize the local solution. Check and remove any line if the removal of the line
+ * still keeps all the affected points points separated by any other line.
+ * Passes are repeated until no line can be removed
+ */
+void OptimizeSolution(Solver *solver)
 {
-	_2DPoint *p1 = (_2DPoint *)ptr1;
-	_2DPoint *p2 = (_2DPoint *)ptr2;
-
-	if ((*p1).xValue > (*p2).xValue) {
-		return (1);
-	}
-
-	if ((*p1).xValue < (*p2).xValue) {
-		return (-1);
+	int index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[index];
+		if (l->isCommitted)
+		{
+			solver->myLineAtGap[l->lineAxis][l->leftRank] = l;
+		}
+		index++;
 	}
 
-	return (0);
+	memset(solver->myBandMark, 0, sizeof(int) * (size_t)solver->myNumberOfPoints);
+	solver->myBandEpoch = 0;
+	int removed;
+	do
+	{
+		int first = X;
+		if (solver->myIsRandomized && (NextRandom(&solver->myRandomState) & 1))
+		{
+			first = Y;
+		}
+		removed = RemoveRedundantLines(solver, first);
+		removed += RemoveRedundantLines(solver, first == X ? Y : X);
+	} while (removed && !IsPastDeadline(solver));
 }
 
-/* Check if any horizontal lines can be removed such that all the affected points are seperated by any other committed line */
-void RemoveRedundantYLines()
+/* Commit the candidate lines greedily, alternating the axes in the order AddLines built them */
+void CommitGreedyLines(Solver *solver)
 {
-	for (int index = 0; index < myCommittedYLineCount; index++)
+	if (solver->myGreedy == MAX_GAIN_GREEDY)
 	{
-		// y value of the line at the immediate left of the current line considered for validation
-		float rightLineY = 0;
-
-		// y value of the line at the immediate right of the current line considered for validation
-		float leftLineY;
-
-		// List of points in between the immediate left and right line of the current line considered for validation
-		_2DPoint pointsInRange[MAX_PTS];
-		int pointsInRangeCount = 0;
-
-		if (index > 0)
-		{
-			int actualRightIndex = index - 1;
-			if (mySortedYAxislines[actualRightIndex].isCommitted)
-			{
-				rightLineY = mySortedYAxislines[actualRightIndex].intersectionValue;
-			}
-			else
-			{
-				while (!mySortedYAxislines[actualRightIndex].isCommitted)
-				{
-					actualRightIndex--;
-					if (actualRightIndex < 0)
-					{
-						rightLineY = 0;
-						break;
-					}
-				}
-				if (actualRightIndex >=0 && mySortedYAxislines[actualRightIndex].isCommitted)
-				{
-					rightLineY = mySortedYAxislines[actualRightIndex].intersectionValue;
-				}
-			}
+		CommitMaxGainLines(solver);
+		return;
+	}
 
+	int clx = 0;
+	int cly = 0;
+	int con;
+	while (solver->myRemainingConnections && clx < solver->myNumberOfLinesInXAxis && cly < solver->myNumberOfLinesInYAxis) {
+		if ((clx & 63) == 0 && IsPastDeadline(solver)) {
+			break;
 		}
-		if (index == myCommittedYLineCount - 1)
-		{
-			//leftLineY = (*(sorted_y_pt + (n_pts - 1)))->pt_y + 1;
-			leftLineY = (*mySortedYPoints[myNumberOfPoints - 1]).yValue + 0.5;
-		}
-		else
-		{
-			leftLineY = mySortedYAxislines[index + 1].intersectionValue;
-		}
-
-		/* get all the points within left and right line */
-		for (int i = 0; i < myNumberOfPoints; i++)
-		{
-			//if ((*(sorted_y_pt+i))->pt_y >= rightLineY && (*(sorted_y_pt + i))->pt_y <= leftLineY)
-			if ((*mySortedYPoints[i]).yValue >= rightLineY && (*mySortedYPoints[i]).yValue <= leftLineY)
-			{
-				pointsInRange[pointsInRangeCount++] = **(mySortedYPoints+i);
-				//pointsInRange[pointsInRangeCount++] = *sorted_y_pt[i];
-			}
+		Line *first = &(solver->myXAxisLines[clx]);
+		Line *second = &(solver->myYAxisLines[cly]);
+		if (solver->myIsRandomized && (NextRandom(&solver->myRandomState) & 1)) {
+			first = &(solver->myYAxisLines[cly]);
+			second = &(solver->myXAxisLines[clx]);
 		}
-			
-		/* sort the points in range by x value */
-		qsort(&pointsInRange, pointsInRangeCount, sizeof(_2DPoint), &CompareXValue);
-
-		int thereExistsALine = 1;
-
-		/* check if any line separates every consecutive points horizontally */
-		for (int i = 0; i < pointsInRangeCount-1; i++)
-		{
-			int lineExists = 0;
-			int lowerBound = pointsInRange[i].xValue;
-			int upperBound;
-
-			upperBound = pointsInRange[i+1].xValue;
 
-			for (int k = 0; k < myCommittedXLineCount; k++)
-			{
-				if (mySortedXAxislines[k].isCommitted == 1  && lowerBound <= mySortedXAxislines[k].intersectionValue && upperBound >= mySortedXAxislines[k].intersectionValue)
-				{
-					lineExists = 1;
-					break;
-				}
-				lineExists = 0;
-			}
-
-			if (!lineExists)
-			{
-				thereExistsALine = 0;
-				break;
-			}			
+		con = CheckConnection(solver, first);
+		if (con) {
+			CommitLine(solver, first);
 		}
+		clx++;
 
-		/* If any horizontal line separates every consecutive points in range sorted by x value, then uncommitt the current considered ine */
-		if (thereExistsALine)
-		{
-			for (int k = 0; k < myCommittedXLineCount + myCommittedYLineCount; k++)
-			{
-				if (mySortedYAxislines[index].lineAxis == myCommittedLines[k]->lineAxis && mySortedYAxislines[index].intersectionValue == myCommittedLines[k]->intersectionValue)
-				{
-					myCommittedLines[k]->isCommitted = 0;
-					mySortedYAxislines[index].isCommitted = 0;
-				}
-			}
+		con = CheckConnection(solver, second);
+		if (con) {
+			CommitLine(solver, second);
 		}
+		cly++;
 	}
 }
 
-/* Optimize the local solution. Check and remove any line if the removal of the line
- * still keeps all the affected points points separated by any other line
+/* Remove the redundant lines of the greedy solution and run the local optimization when asked.
+ * With the early exit a greedy solution meeting the lower bound is optimal and left as it is
  */
-void OptimizeSolution()
+void ImproveSolution(Solver *solver)
 {
-	myCommittedXLineCount = 0;
-	myCommittedYLineCount = 0;
-
-	/* get all the vertical lines from the local solution */
-	for(int index = 0; index < myNumberOfLinesInXAxis; index++)
+	if (solver->myEarlyExit && !solver->myRemainingConnections && CountCommittedLines(solver) <= solver->myBounds.best)
 	{
-		if (myXAxisLines[index].isCommitted)
-		{
-			mySortedXAxislines[myCommittedXLineCount++] = myXAxisLines[index];
-		}
+		return;
 	}
-
-	/* get all the horizontal lines from the local solution */
-	for (int index = 0; index < myNumberOfLinesInYAxis; index++)
+	OptimizeSolution(solver);
+	if (solver->myLocalSearch)
 	{
-		if (myYAxisLines[index].isCommitted)
-		{
-			mySortedYAxislines[myCommittedYLineCount++] = myYAxisLines[index];
-		}
+		OptimizeLocally(solver);
 	}
-
-	/* sort vertical line list and horizontal line list */
-	qsort(&mySortedXAxislines, myCommittedXLineCount, sizeof(Line), &SortByIntersectionValue);
-	qsort(&mySortedYAxislines, myCommittedYLineCount, sizeof(Line), &SortByIntersectionValue);
-
-	RemoveRedundantXLines();
-	RemoveRedundantYLines();
 }
 
-/* Read input data from the file and validate */
-int ReadInputFile(char* fileName)
+/* Run the whole pipeline on the instance read into the solver: build the candidate lines,
+ * commit them greedily alternating the axes, then remove the redundant ones
+ */
+void Solve(Solver *solver)
 {
-	/* Open the file*/
-	FILE *instance = fopen(fileName, "r");
-	if (instance == NULL) 
+	if (solver->myExact)
 	{
-		return (FILE_NOT_FOUND);
+		SolveExact(solver);
+		return;
 	}
-
-	/* read number of points from the file */
-	int numberOfPoints;
-	int ret = fscanf(instance, "%d", &numberOfPoints);
-	myNumberOfPoints = numberOfPoints;
-
-	int x = 0;
-	int y = 0;
-	int i = 0;
-
-	if (ret == EOF) {
-		return (NO_POINTS);
+	if (solver->myTimeLimit > 0)
+	{
+		SolveAnytime(solver);
+		return;
 	}
-
-	/* read the points into a points list */
-	while (fscanf(instance, "%d %d", &x, &y) != EOF && i < MAX_PTS) {
-		my2DPoints[i].xValue = x;
-		my2DPoints[i].yValue = y;
-		my2DPoints[i].numberOfConnections = 0;
-		i++;
+	if (solver->myNumberOfParts > 1)
+	{
+		SolveDecomposed(solver);
+		return;
 	}
-
-	/* check if expected number of points have been read from the file */
-	if (i != myNumberOfPoints) {
-		return (POINTS_MORE_LESS);
+	if (solver->myNumberOfRestarts > 1)
+	{
+		SolveMultiStart(solver);
+		return;
 	}
 
-	int j = 0;
-	while (j < myNumberOfPoints) {
-		mySortedXPoints[j] = &(my2DPoints[j]);
-		mySortedYPoints[j] = &(my2DPoints[j]);
-		j++;
-	}
+	STATS_START(timer);
+	SortInputPoints(solver);
+	ComputeLowerBounds(solver);
+	STATS_LAP(solver, SORT_PHASE, timer);
+	InitializePoints(solver);
+	STATS_LAP(solver, INITIALIZE_PHASE, timer);
+
+	AddLines(solver, X, 0, solver->myNumberOfPoints - 1);
+	AddLines(solver, Y, 0, solver->myNumberOfPoints - 1);
+	STATS_LAP(solver, CANDIDATE_PHASE, timer);
+
+	CommitGreedyLines(solver);
+	STATS_LAP(solver, GREEDY_PHASE, timer);
+	ImproveSolution(solver);
+	STATS_LAP(solver, OPTIMIZE_PHASE, timer);
+	solver->myIsFinished = !solver->myIsTimedOut;
+}
 
-	return SUCCESS;
+/* Set the options to the defaults of the command line, a plain single file run */
+void InitializeOptions(Options *options)
+{
+	options->engine = CELL_ENGINE;
+	options->greedy = MIDPOINT_GREEDY;
+	options->isLocalSearch = 0;
+	options->numberOfRestarts = 1;
+	options->seed = DEFAULT_SEED;
+	options->timeLimit = 0;
+	options->isEarlyExit = 0;
+	options->isExact = 0;
+	options->updateFile = NULL;
+	options->numberOfQueries = 0;
+	options->isVerifying = 0;
+	options->numberOfParts = 0;
+	options->numberOfWorkers = 1;
+	options->isBatch = 0;
+	options->isVerbose = 0;
+	options->isBinaryOutput = 0;
+	options->statsFile = NULL;
 }
 
-int main(int argc, char* argv[])
+/* Check the options for combinations that cannot run together. Returns the message of the
+ * first one found, NULL when there is none
+ */
+const char *CheckOptions(const Options *options)
 {
-	if(argc < 2)
+	if (options->greedy == MAX_GAIN_GREEDY && options->engine != CELL_ENGINE)
 	{
-		fprintf(stderr, READ_NO_FILE_ERR);
-		exit(0);
+		return (MAX_GAIN_ENGINE_ERR);
 	}
-		
-	int index = 1;
-	while(index < argc)
+	if (options->updateFile != NULL && (options->isBatch || options->isBinaryOutput))
 	{
-		int fileStatus = ReadInputFile(argv[index]);
-		if (fileStatus != SUCCESS)
-		{
-			switch (fileStatus)
-			{
-				case FILE_NOT_FOUND:
-					(void)fprintf(stderr, NO_FILE_ERR, argv[index]);
-					exit(0);
-
-				case POINTS_MORE_LESS:
-					(void)fprintf(stderr, READ_N_POINTS_ERR, argv[index]);
-					exit(0);
-
-				case NO_POINTS:
-					(void)fprintf(stderr, READ_NO_POINTS_ERR, argv[index]);
-					(void)fprintf(stderr, READ_ONLY_HEAD);
-					(void)fprintf(stderr, "Quitting\n");
-					exit(0);
-				default: break;
-			}
-			exit(0);
-		}
+		return (UPDATE_MODE_ERR);
+	}
+	if (options->numberOfQueries > 0 && options->isBatch)
+	{
+		return (LOCATE_MODE_ERR);
+	}
+	if (options->numberOfParts > 1 && (options->isExact || options->timeLimit > 0))
+	{
+		return (DECOMPOSE_MODE_ERR);
+	}
+	return (NULL);
+}
 
-		SortInputPoints();
-		InitializePoints();
+/* Print the error message matching the status of the input file */
+void ReportFileStatus(int fileStatus, char *fileName)
+{
+	switch (fileStatus)
+	{
+		case FILE_NOT_FOUND:
+			(void)fprintf(stderr, NO_FILE_ERR, fileName);
+			break;
 
-		AddLines(X, 0, myNumberOfPoints - 1);
-		AddLines(Y, 0, myNumberOfPoints - 1);
+		case POINTS_MORE_LESS:
+			(void)fprintf(stderr, READ_N_POINTS_ERR, fileName);
+			break;
 
+		case NO_POINTS:
+			(void)fprintf(stderr, READ_NO_POINTS_ERR, fileName);
+			(void)fprintf(stderr, READ_ONLY_HEAD);
+			break;
 
-		int clx = 0;
-		int cly = 0;
-		int con;
-		while (myRemainingConnections && clx < myNumberOfLinesInXAxis && cly < myNumberOfLinesInYAxis) {
-			con = CheckConnection(&(myXAxisLines[clx]));
-			if (con) {
-				CommitLine(&(myXAxisLines[clx]));
-			}
-			clx++;
+		case BAD_FORMAT:
+			(void)fprintf(stderr, READ_BAD_FORMAT_ERR, fileName);
+			break;
+		default: break;
+	}
+}
 
-			con = CheckConnection(&(myYAxisLines[cly]));
-			if (con) {
-				CommitLine(&(myYAxisLines[cly]));
-			}
-			cly++;
-		}
+/* Print that the file is solved, with the parse throughput when verbose */
+void ReportSolved(Solver *solver, char *fileName, const Options *options)
+{
+	printf("Solved %s\n", fileName);
+	int numberOfLines = CountCommittedLines(solver);
+	printf(BOUND_REPORT, fileName, numberOfLines, solver->myBounds.best, solver->myBounds.counting,
+		solver->myBounds.increasing, solver->myBounds.decreasing, solver->myBounds.neighbours[X],
+		solver->myBounds.neighbours[Y], numberOfLines - solver->myBounds.best);
+	if (solver->myExact)
+	{
+		printf(EXACT_REPORT, fileName, numberOfLines, solver->myIsFinished ? "optimal" : "deadline reached",
+			solver->myNumberOfNodes);
+	}
+	else if (solver->myTimeLimit > 0)
+	{
+		printf(ANYTIME_REPORT, fileName, numberOfLines, solver->myNumberOfRuns,
+			solver->myIsFinished ? "finished" : "deadline reached");
+	}
+	else if (solver->myNumberOfParts > 1)
+	{
+		printf(DECOMPOSE_REPORT, fileName, solver->myNumberOfParts, solver->myNumberOfPartLines, numberOfLines);
+	}
+	/* with updates the solution written is the updated one, which SolveUpdates verifies */
+	if (options->isVerifying && options->updateFile == NULL)
+	{
+		Verification result;
+		(void)VerifySolution(solver, &result);
+		ReportVerification(fileName, solver->myValues[X], solver->myValues[Y], &result);
+	}
+	if (options->isVerbose)
+	{
+		double megabytes = (double)solver->myInputBytes / (1024 * 1024);
+		printf(PARSE_THROUGHPUT, fileName, megabytes, solver->myParseTime * 1000,
+			solver->myParseTime > 0 ? megabytes / solver->myParseTime : 0.0);
+	}
+#ifdef SEPARATING_LINES_STATS
+	WriteStatsRecord(solver, fileName, options->statsFile != NULL ? options->statsFile : stdout);
+#endif
+}
 
-		OptimizeSolution();
+/* Get the next number of a splitmix64 sequence, small and good enough to generate instances */
+unsigned long long NextRandom(unsigned long long *state)
+{
+	unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return (z ^ (z >> 31));
+}
 
-		WriteOutputFile(argv[index]);
-		printf("Solved %s\n", argv[index]);
-		FreeConnections();
-		index++;
+/* Get a monotonic wall clock time in seconds */
+double GetWallClock()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((double)now.tv_sec + (double)now.tv_nsec / 1e9);
+}
+
+/* Whether the deadline of an anytime run has passed, always false without a deadline */
+int IsPastDeadline(Solver *solver)
+{
+	if (solver->myDeadline > 0 && !solver->myIsTimedOut && GetWallClock() >= solver->myDeadline)
+	{
+		solver->myIsTimedOut = 1;
 	}
-	return 0;
+	return (solver->myIsTimedOut);
 }
@@ -1,74 +1,300 @@
-#pragma once
-#ifndef SEPARATING_LINES_H
-#define  SEPARATING_LINES_H
-
-/* Includes */
+#pragma once
+#ifndef SEPARATING_LINES_H
+#define  SEPARATING_LINES_H
+
+/* Includes */
 #include <stdlib.h>
 #include <stdio.h>
-#include <ctype.h>
-
-/* Definitions */
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "SolverStats.h"
+
+/* Definitions */
 #define	READ_N_POINTS_ERR "The file %s has more|less points than it should\n"
 #define	NO_FILE_ERR "No file with name [%s] found\n"
 #define	READ_NO_POINTS_ERR "There are no points in file %s\n"
 #define	READ_ONLY_HEAD "Only the header value was found\n"
+#define	READ_BAD_FORMAT_ERR "The file %s is not a valid binary file\n"
 #define READ_NO_FILE_ERR "No instance of file input\n"
+#define	UNKNOWN_ENGINE_ERR "Unknown engine [%s], expected pairwise or cell\n"
+#define	UNKNOWN_GREEDY_ERR "Unknown greedy [%s], expected midpoint or maxgain\n"
+#define	USAGE_ERR "Usage: %s [-e pairwise|cell] [-g midpoint|maxgain] [-l] [-r restarts] [-R seed] [-t ms] [-q] [-x] [-u updates] [-L queries] [-k] [-p parts] [-j threads] [-v] [-b] [-s stats] file...\n       %s -c input output\n       %s -V instance solution\n       %s [-e pairwise|cell] [-g midpoint|maxgain] [-l] -B max_points\n"
+#define	OUT_OF_MEMORY_ERR "Unable to allocate %lu bytes of solver storage\n"
+
+/* Every block handed out by the arena starts on a cache line boundary */
+#define	ARENA_ALIGNMENT	64
+#define	ARENA_MIN_BLOCK	(1 << 20)
+
+/* Connection rows hold one bit per point and are padded to whole cache lines */
+#define	CONNECTION_WORD_BITS	64
+#define	CONNECTION_ROW_ALIGN_WORDS	(ARENA_ALIGNMENT / sizeof(ConnectionWord))
 
-#define	MAX_PTS	100
-
-/* Type Definitions */
+/* Type Definitions */
 typedef enum axis
 {
 	X,
 	Y
 } Axis;
 
+/* How the solver tracks which points are still connected */
+typedef enum engine
+{
+	PAIRWISE_ENGINE,
+	CELL_ENGINE
+} Engine;
+
+/* Order in which the greedy commits the candidate lines */
+typedef enum greedy
+{
+	MIDPOINT_GREEDY,
+	MAX_GAIN_GREEDY
+} Greedy;
+
+/* Command line options shared by the single file and the batch modes */
+typedef struct options
+{
+	Engine engine;
+	Greedy greedy;
+	int isLocalSearch;
+	int numberOfRestarts;
+	unsigned long long seed;
+
+	/* Skip the optimization when the greedy already meets the lower bound */
+	int isEarlyExit;
+
+	/* Anytime mode budget in seconds, 0 when the solver runs to completion */
+	double timeLimit;
+
+	/* Search for a solution with the fewest lines instead of a greedy one */
+	int isExact;
+
+	/* Points to insert and delete once the instance is solved, NULL for none */
+	char *updateFile;
+
+	/* Size of the point location benchmark run on every solution, 0 for none */
+	int numberOfQueries;
+
+	/* Check every solution with the verifier */
+	int isVerifying;
+
+	/* Solve the instance as this many parts in parallel, 0 to solve it whole */
+	int numberOfParts;
+	int numberOfWorkers;
+	int isBatch;
+	int isVerbose;
+	int isBinaryOutput;
+
+	/* Where the statistics records go, stdout when not given */
+	FILE *statsFile;
+} Options;
+
 typedef enum FileStatus
 {
 	SUCCESS,
 	NO_POINTS,
 	POINTS_MORE_LESS,
 	FILE_NOT_FOUND,
+	BAD_FORMAT,
 } Status;
 
+typedef uint64_t ConnectionWord;
+
+/* A line lies in the gap between the points of rank leftRank and leftRank + 1 along its
+ * axis. The real coordinate is only worked out when the solution is written
+ */
 typedef struct line
 {
 	int	lineAxis;
 	int	isCommitted;
-	float intersectionValue;
+	int	leftRank;
 }Line;
 
-typedef struct point _2DPoint;
-struct point
+/* Lower bounds on the number of lines of any solution of the instance */
+typedef struct lowerBounds
+{
+	int counting;
+	int increasing;
+	int decreasing;
+	int neighbours[2];
+	int best;
+} LowerBounds;
+
+/* A chunk of raw memory owned by the arena, blocks are chained newest first */
+typedef struct arenaBlock ArenaBlock;
+struct arenaBlock
+{
+	ArenaBlock *previous;
+	char *base;
+	size_t capacity;
+	size_t used;
+};
+
+/* Per instance storage, carved linearly and reset between input files */
+typedef struct arena
+{
+	ArenaBlock *current;
+	size_t totalCapacity;
+
+	/* Bytes handed out since the last reset */
+	size_t allocatedBytes;
+} Arena;
+
+/* Position of the arena, the scratch memory carved after it is handed back by ArenaRewind */
+typedef struct arenaMark
+{
+	ArenaBlock *block;
+	size_t used;
+	size_t allocatedBytes;
+} ArenaMark;
+
+/* Every piece of state of one solver instance. Solvers share nothing, so one
+ * solver per thread can run concurrently
+ */
+typedef struct solver
 {
-	int	xValue;
-	int	yValue;
-	int	numberOfConnections;
-	int	id;
-	_2DPoint **pointerToConnectedPoints;
-};
-
-/* Data members*/
-_2DPoint my2DPoints[MAX_PTS];
-
-_2DPoint *mySortedXPoints[MAX_PTS];
-
-_2DPoint *mySortedYPoints[MAX_PTS];
-
-Line myXAxisLines[MAX_PTS];
-int myCommittedXLineCount;
-Line myYAxisLines[MAX_PTS];
-int myCommittedYLineCount;
-
-Line *myCommittedLines[MAX_PTS];
-
-Line mySortedXAxislines[MAX_PTS];
-Line mySortedYAxislines[MAX_PTS];
-
-int myNumberOfLinesInXAxis = 0;
-int myNumberOfLinesInYAxis = 0;
-int myNumberOfLines = 0;
-int myNumberOfPoints = 0;
-int myRemainingConnections = 0;
-
-#endif
+	Arena myArena;
+
+	/* The points are stored as columns indexed by axis. Ids follow the input order, and
+	 * a scan along one axis reads the columns by rank, which are laid out in that order
+	 */
+
+	/* Coordinate and rank of every point along each axis, by id */
+	int *myValues[2];
+	int *myRanks[2];
+
+	/* Id, coordinate and rank along the other axis of the point at every rank of each axis */
+	int *mySortedIds[2];
+	int *mySortedValues[2];
+	int *myOtherRanks[2];
+
+	/* Connections left to every point by id, pairwise engine */
+	int *myNumberOfConnections;
+
+	Line *myXAxisLines;
+	Line *myYAxisLines;
+
+	Line **myCommittedLines;
+
+	/* Committed line at every gap of each axis, used to uncommit the redundant ones */
+	Line **myLineAtGap[2];
+
+	/* Bit matrix of the points still connected, row i bit j is set while i and j share a cell */
+	ConnectionWord *myConnections;
+	size_t myConnectionRowWords;
+
+	/* Bit mask of the points on one side of the line currently checked or committed */
+	ConnectionWord *myLineMask;
+
+	Engine myEngine;
+	Greedy myGreedy;
+
+	/* Message of the first bad combination in the options of the solver, NULL when they can run */
+	const char *myOptionsError;
+	int myLocalSearch;
+	int myEarlyExit;
+	LowerBounds myBounds;
+
+	/* Multi-start settings and the random state of a randomized restart */
+	int myNumberOfRestarts;
+	int myRestartWorkers;
+	unsigned long long mySeed;
+	int myIsRandomized;
+	unsigned long long myRandomState;
+
+	/* Anytime budget, the absolute deadline of the current run and whether it was reached */
+	double myTimeLimit;
+	double myDeadline;
+	int myIsTimedOut;
+	int myIsFinished;
+	int myNumberOfRuns;
+
+	/* Exact search and the number of nodes it visited */
+	int myExact;
+	long long myNumberOfNodes;
+
+	/* Spatial decomposition, the number of parts and the lines of the parts before the boundary pass */
+	int myNumberOfParts;
+	int myNumberOfPartLines;
+
+	/* Cell of every point by id. Two points are connected exactly when they share a cell */
+	int *myCellOfPoint;
+	int *myCellSize;
+	int myNumberOfCells;
+
+	/* Per cell marks of the line being checked or committed, valid when equal to the epoch */
+	int *myCellMark;
+	int *myCellSplitMark;
+	int *myCellSplit;
+	int myCellEpoch;
+
+	/* Committed gaps per axis, bit g is set when the line between ranks g and g+1 is committed */
+	ConnectionWord *myCommittedGaps[2];
+
+	/* Number of committed gaps of one axis below every rank, i.e. the band of a point along that axis */
+	int *myGapPrefix;
+
+	/* Per band marks of the slab being checked by the redundant line removal */
+	int *myBandMark;
+	int myBandEpoch;
+
+	int myNumberOfLinesInXAxis;
+	int myNumberOfLinesInYAxis;
+	int myNumberOfLines;
+	int myNumberOfPoints;
+	long long myRemainingConnections;
+
+	/* Size of the instance file and the time taken to parse it */
+	size_t myInputBytes;
+	double myParseTime;
+
+	SolverStats myStats;
+} Solver;
+
+/* Functions */
+void *ArenaAlloc(Arena *arena, size_t size);
+void ReportOutOfMemory(size_t size);
+void *AllocateStorage(size_t size);
+void *AllocateClearedStorage(size_t count, size_t size);
+void *ResizeStorage(void *memory, size_t size);
+void ArenaReset(Arena *arena);
+ArenaMark ArenaGetMark(const Arena *arena);
+void ArenaRewind(Arena *arena, const ArenaMark *mark);
+void ArenaFree(Arena *arena);
+
+void InitializeSolver(Solver *solver, const Options *options);
+void FreeSolver(Solver *solver);
+void CopySolverSettings(Solver *solver, const Solver *source);
+void CopyInstance(Solver *solver, const Solver *source);
+void AllocateSolverStorage(Solver *solver, int numberOfPoints);
+int ReadInputFile(Solver *solver, char* fileName);
+void SortInputPoints(Solver *solver);
+void InitializeCommittedGaps(Solver *solver);
+void InitializePoints(Solver *solver);
+void AddLines(Solver *solver, int axis, int from, int to);
+int PreviousCommittedGap(Solver *solver, int axis, int gap);
+int NextCommittedGap(Solver *solver, int axis, int gap);
+int CheckConnection(Solver *solver, Line *ln);
+void CommitLine(Solver *solver, Line *l);
+void OptimizeSolution(Solver *solver);
+void CommitGreedyLines(Solver *solver);
+void ImproveSolution(Solver *solver);
+void Solve(Solver *solver);
+int CountCommittedLines(Solver *solver);
+long long GetDoubledIntersectionValue(Solver *solver, Line *l);
+void GetSolutionFileName(char *fileName, char *solutionName, const char *suffix);
+void WriteOutputFile(Solver *solver, char* fileName);
+void WriteSolutionFile(Solver *solver, const char *solutionName);
+void WriteSolution(Solver *solver, char *fileName, const Options *options);
+void ResetSolverStorage(Solver *solver);
+void InitializeOptions(Options *options);
+const char *CheckOptions(const Options *options);
+void ReportFileStatus(int fileStatus, char *fileName);
+void ReportSolved(Solver *solver, char *fileName, const Options *options);
+void WriteStatsRecord(Solver *solver, const char *fileName, FILE *out);
+double GetWallClock();
+int IsPastDeadline(Solver *solver);
+unsigned long long NextRandom(unsigned long long *state);
+
+#endif
@@ -0,0 +1,75 @@
+/* In-process entry points. The points come from coordinate arrays owned by the
+* caller and the lines go to a buffer owned by the caller, so no file is read or
+* written. SolvePoints solves on a solver of its own and can be called from any
+* number of threads at once; SolveInstance reuses the storage of a caller's
+* solver from one call to the next, which saves the allocations when many small
+* instances are solved in a row.
+*/
+
+#include "SeparatingLinesLibrary.h"
+
+/* Load the coordinates into an empty solver */
+void LoadPoints(Solver *solver, const int *xValues, const int *yValues, int numberOfPoints)
+{
+	solver->myNumberOfPoints = numberOfPoints;
+	AllocateSolverStorage(solver, numberOfPoints);
+	memcpy(solver->myValues[X], xValues, sizeof(int) * (size_t)numberOfPoints);
+	memcpy(solver->myValues[Y], yValues, sizeof(int) * (size_t)numberOfPoints);
+}
+
+/* Solve the points on an initialized solver and store the lines, at most
+ * MAX_SOLUTION_LINES(numberOfPoints) of them. Returns the number of lines and leaves the
+ * solver empty for the next instance, or -1 when the options of the solver cannot run together
+ */
+int SolveInstance(Solver *solver, const int *xValues, const int *yValues, int numberOfPoints, SeparatingLine *lines)
+{
+	if (solver->myOptionsError != NULL)
+	{
+		return (-1);
+	}
+	if (numberOfPoints < 1)
+	{
+		return (0);
+	}
+	LoadPoints(solver, xValues, yValues, numberOfPoints);
+	Solve(solver);
+
+	int numberOfLines = 0;
+	int index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[index];
+		if (l->isCommitted)
+		{
+			lines[numberOfLines].axis = (Axis)l->lineAxis;
+			lines[numberOfLines].coordinate = (double)GetDoubledIntersectionValue(solver, l) / 2;
+			numberOfLines++;
+		}
+		index++;
+	}
+	ResetSolverStorage(solver);
+	return (numberOfLines);
+}
+
+/* Solve the points with the given options, NULL for the defaults, and store the lines.
+ * Returns -1 for options that cannot run together or that only the command line has,
+ * an update file or a query benchmark
+ */
+int SolvePoints(const int *xValues, const int *yValues, int numberOfPoints, const Options *options, SeparatingLine *lines)
+{
+	Options defaults;
+	if (options == NULL)
+	{
+		InitializeOptions(&defaults);
+		options = &defaults;
+	}
+	if (CheckOptions(options) != NULL || options->updateFile != NULL || options->numberOfQueries > 0)
+	{
+		return (-1);
+	}
+	Solver solver;
+	InitializeSolver(&solver, options);
+	int numberOfLines = SolveInstance(&solver, xValues, yValues, numberOfPoints, lines);
+	FreeSolver(&solver);
+	return (numberOfLines);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#ifndef SEPARATING_LINES_LIBRARY_H
+#define  SEPARATING_LINES_LIBRARY_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+
+/* No solution has more lines than there are gaps, a line buffer of this size always suffices */
+#define	MAX_SOLUTION_LINES(numberOfPoints)	((numberOfPoints) > 1 ? 2 * ((numberOfPoints) - 1) : 0)
+
+/* Type Definitions */
+
+/* A line of a solution, vertical (X) or horizontal (Y), halfway between two integer coordinates */
+typedef struct separatingLine
+{
+	Axis axis;
+	double coordinate;
+} SeparatingLine;
+
+/* Functions */
+void LoadPoints(Solver *solver, const int *xValues, const int *yValues, int numberOfPoints);
+int SolveInstance(Solver *solver, const int *xValues, const int *yValues, int numberOfPoints, SeparatingLine *lines);
+int SolvePoints(const int *xValues, const int *yValues, int numberOfPoints, const Options *options, SeparatingLine *lines);
+
+#endif
@@ -0,0 +1,252 @@
+/* Command line front end. Parses the options and solves the instance files one
+* after the other, or hands them to the batch solver, the benchmark suite or the
+* format converter. Everything else lives in the solver library, which can be
+* linked without this file.
+*/
+
+#include "SeparatingLines.h"
+#include "BatchSolver.h"
+#include "InstanceParser.h"
+#include "BinaryFormat.h"
+#include "Benchmark.h"
+#include "MaxGainGreedy.h"
+#include "IncrementalSolver.h"
+#include "PointLocation.h"
+#include "SolutionVerifier.h"
+#include "SpatialDecomposition.h"
+
+/* Quit on options that cannot be combined */
+void ValidateOptions(const Options *options)
+{
+	const char *error = CheckOptions(options);
+	if (error != NULL)
+	{
+		(void)fprintf(stderr, "%s", error);
+		exit(0);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	InitializeOptions(&options);
+	int index = 1;
+	while (index < argc && argv[index][0] == '-')
+	{
+		if (strcmp(argv[index], "-e") == 0 && index + 1 < argc)
+		{
+			if (strcmp(argv[index + 1], "pairwise") == 0)
+			{
+				options.engine = PAIRWISE_ENGINE;
+			}
+			else if (strcmp(argv[index + 1], "cell") == 0)
+			{
+				options.engine = CELL_ENGINE;
+			}
+			else
+			{
+				(void)fprintf(stderr, UNKNOWN_ENGINE_ERR, argv[index + 1]);
+				exit(0);
+			}
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-g") == 0 && index + 1 < argc)
+		{
+			if (strcmp(argv[index + 1], "midpoint") == 0)
+			{
+				options.greedy = MIDPOINT_GREEDY;
+			}
+			else if (strcmp(argv[index + 1], "maxgain") == 0)
+			{
+				options.greedy = MAX_GAIN_GREEDY;
+			}
+			else
+			{
+				(void)fprintf(stderr, UNKNOWN_GREEDY_ERR, argv[index + 1]);
+				exit(0);
+			}
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-j") == 0 && index + 1 < argc)
+		{
+			/* 0 threads means one per core */
+			options.numberOfWorkers = atoi(argv[index + 1]);
+			options.isBatch = 1;
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-l") == 0)
+		{
+			options.isLocalSearch = 1;
+			index++;
+			continue;
+		}
+		if (strcmp(argv[index], "-r") == 0 && index + 1 < argc)
+		{
+			options.numberOfRestarts = atoi(argv[index + 1]);
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-R") == 0 && index + 1 < argc)
+		{
+			options.seed = strtoull(argv[index + 1], NULL, 0);
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-t") == 0 && index + 1 < argc)
+		{
+			options.timeLimit = atof(argv[index + 1]) / 1000;
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-q") == 0)
+		{
+			options.isEarlyExit = 1;
+			index++;
+			continue;
+		}
+		if (strcmp(argv[index], "-x") == 0)
+		{
+			options.isExact = 1;
+			index++;
+			continue;
+		}
+		if (strcmp(argv[index], "-u") == 0 && index + 1 < argc)
+		{
+			options.updateFile = argv[index + 1];
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-L") == 0 && index + 1 < argc)
+		{
+			options.numberOfQueries = atoi(argv[index + 1]);
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-k") == 0)
+		{
+			options.isVerifying = 1;
+			index++;
+			continue;
+		}
+		if (strcmp(argv[index], "-p") == 0 && index + 1 < argc)
+		{
+			options.numberOfParts = atoi(argv[index + 1]);
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-v") == 0)
+		{
+			options.isVerbose = 1;
+			index++;
+			continue;
+		}
+		if (strcmp(argv[index], "-b") == 0)
+		{
+			options.isBinaryOutput = 1;
+			index++;
+			continue;
+		}
+		if (strcmp(argv[index], "-s") == 0 && index + 1 < argc)
+		{
+#ifndef SEPARATING_LINES_STATS
+			(void)fprintf(stderr, STATS_DISABLED_ERR);
+#endif
+			if (options.statsFile != NULL)
+			{
+				fclose(options.statsFile);
+			}
+			options.statsFile = fopen(argv[index + 1], "a");
+			if (options.statsFile == NULL)
+			{
+				(void)fprintf(stderr, STATS_FILE_ERR, argv[index + 1]);
+				exit(0);
+			}
+			index += 2;
+			continue;
+		}
+		if (strcmp(argv[index], "-B") == 0 && index + 1 < argc)
+		{
+			int maxPoints = atoi(argv[index + 1]);
+			if (maxPoints < BENCHMARK_MIN_POINTS)
+			{
+				maxPoints = BENCHMARK_MIN_POINTS;
+			}
+			ValidateOptions(&options);
+			return (RunBenchmark(maxPoints, &options));
+		}
+		if (strcmp(argv[index], "-V") == 0 && index + 2 < argc)
+		{
+			Solver solver;
+			InitializeSolver(&solver, &options);
+			int result = VerifySolutionFile(&solver, argv[index + 1], argv[index + 2]);
+			FreeSolver(&solver);
+			return (result);
+		}
+		if (strcmp(argv[index], "-c") == 0 && index + 2 < argc)
+		{
+			int fileStatus = ConvertFile(argv[index + 1], argv[index + 2]);
+			if (fileStatus != SUCCESS)
+			{
+				ReportFileStatus(fileStatus, argv[index + 1]);
+				(void)fprintf(stderr, CONVERT_ERR, argv[index + 1], argv[index + 2]);
+				return (1);
+			}
+			return (0);
+		}
+		(void)fprintf(stderr, USAGE_ERR, argv[0], argv[0], argv[0], argv[0]);
+		exit(0);
+	}
+
+	ValidateOptions(&options);
+	if(index >= argc)
+	{
+		fprintf(stderr, READ_NO_FILE_ERR);
+		exit(0);
+	}
+
+	if (options.isBatch)
+	{
+		return (SolveBatch(&argv[index], argc - index, &options) ? 1 : 0);
+	}
+
+	Solver instanceSolver;
+	Solver *solver = &instanceSolver;
+	InitializeSolver(solver, &options);
+		
+	while(index < argc)
+	{
+		int fileStatus = ReadInputFile(solver, argv[index]);
+		if (fileStatus != SUCCESS)
+		{
+			ReportFileStatus(fileStatus, argv[index]);
+			if (fileStatus == NO_POINTS)
+			{
+				(void)fprintf(stderr, "Quitting\n");
+			}
+			exit(0);
+		}
+
+		Solve(solver);
+
+		if (options.updateFile == NULL)
+		{
+			WriteSolution(solver, argv[index], &options);
+		}
+		ReportSolved(solver, argv[index], &options);
+		if (options.numberOfQueries > 0)
+		{
+			RunLocateBenchmark(solver, argv[index], options.numberOfQueries);
+		}
+		if (options.updateFile != NULL)
+		{
+			SolveUpdates(solver, argv[index], &options);
+		}
+		ResetSolverStorage(solver);
+		index++;
+	}
+	FreeSolver(solver);
+	return 0;
+}
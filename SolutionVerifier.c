@@ -0,0 +1,310 @@
+/* Solution verifier. Checks a solution without trusting any state of the solver
+* that produced it: every point gets the key of its cell, the number of vertical
+* lines below its x in the high half and of horizontal lines below its y in the
+* low half, each found by a binary search over the sorted lines. The solution is
+* valid when no point lies on a line and no two points share a key, which radix
+* sorting the keys shows in O(n). The keys are computed in chunks on the work pool.
+*/
+
+#include "SolutionVerifier.h"
+#include "InstanceParser.h"
+#include "BinaryFormat.h"
+#include "WorkPool.h"
+#include "RadixSort.h"
+
+int SortByDoubledCoordinate(const void *ptr1, const void *ptr2)
+{
+	int64_t coordinate1 = *(const int64_t *)ptr1;
+	int64_t coordinate2 = *(const int64_t *)ptr2;
+	return (coordinate1 < coordinate2 ? -1 : (coordinate1 > coordinate2));
+}
+
+void SortSolutionLines(SolutionLines *lines)
+{
+	qsort(lines->lines[X], (size_t)lines->numberOfLines[X], sizeof(int64_t), &SortByDoubledCoordinate);
+	qsort(lines->lines[Y], (size_t)lines->numberOfLines[Y], sizeof(int64_t), &SortByDoubledCoordinate);
+}
+
+/* Get the committed lines of a solved solver */
+void GetSolverLines(Solver *solver, SolutionLines *lines)
+{
+	lines->lines[X] = (int64_t *)AllocateStorage(sizeof(int64_t) * (size_t)(solver->myNumberOfLines + 1));
+	lines->lines[Y] = (int64_t *)AllocateStorage(sizeof(int64_t) * (size_t)(solver->myNumberOfLines + 1));
+	lines->numberOfLines[X] = 0;
+	lines->numberOfLines[Y] = 0;
+	int index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[index];
+		if (l->isCommitted)
+		{
+			lines->lines[l->lineAxis][lines->numberOfLines[l->lineAxis]++] = GetDoubledIntersectionValue(solver, l);
+		}
+		index++;
+	}
+	SortSolutionLines(lines);
+}
+
+/* Read a solution file in the text or the binary format */
+int ReadSolutionFile(char *fileName, SolutionLines *lines)
+{
+	InstanceText text;
+	int fileStatus = OpenInstanceText(&text, fileName);
+	if (fileStatus != SUCCESS)
+	{
+		return (fileStatus);
+	}
+	size_t length = (size_t)(text.end - text.begin);
+	const char *cursor = text.begin;
+	BinaryHeader header;
+	int isBinary = IsBinaryFormat(text.begin, length, SOLUTION_MAGIC);
+	long long count = -1;
+	int textCount = 0;
+	if (isBinary)
+	{
+		count = ReadBinaryHeader(text.begin, length, SOLUTION_MAGIC, &header);
+		if (count >= 0 && (header.coordinateBytes != sizeof(int64_t) ||
+			length != BINARY_HEADER_BYTES + GetColumnBytes((size_t)(count + 7) / 8) + GetColumnBytes((size_t)count * sizeof(int64_t))))
+		{
+			count = -1;
+		}
+	}
+	else if (ScanInteger(&cursor, text.end, &textCount) && textCount >= 0 && (size_t)textCount <= length / MIN_POINT_BYTES + 1)
+	{
+		count = textCount;
+	}
+	if (count < 0)
+	{
+		CloseInstanceText(&text);
+		return (BAD_FORMAT);
+	}
+
+	lines->lines[X] = (int64_t *)AllocateStorage(sizeof(int64_t) * (size_t)(count + 1));
+	lines->lines[Y] = (int64_t *)AllocateStorage(sizeof(int64_t) * (size_t)(count + 1));
+	lines->numberOfLines[X] = 0;
+	lines->numberOfLines[Y] = 0;
+	const uint8_t *axes = (const uint8_t *)(text.begin + BINARY_HEADER_BYTES);
+	const char *coordinates = text.begin + BINARY_HEADER_BYTES + GetColumnBytes((size_t)(count + 7) / 8);
+	long long index = 0;
+	while (index < count && fileStatus == SUCCESS)
+	{
+		int axis;
+		int64_t doubled;
+		if (isBinary)
+		{
+			axis = axes[index / 8] >> (index % 8) & 1 ? Y : X;
+			doubled = (int64_t)LoadLittleEndian(coordinates + index * (long long)sizeof(int64_t), sizeof(int64_t));
+		}
+		else
+		{
+			char letter = PeekToken(&cursor, text.end);
+			axis = letter == 'h' ? Y : X;
+			if (letter != 'v' && letter != 'h')
+			{
+				fileStatus = BAD_FORMAT;
+				break;
+			}
+			cursor++;
+			if (!ScanDoubledCoordinate(&cursor, text.end, &doubled))
+			{
+				fileStatus = BAD_FORMAT;
+				break;
+			}
+		}
+		lines->lines[axis][lines->numberOfLines[axis]++] = doubled;
+		index++;
+	}
+	if (fileStatus == SUCCESS && !isBinary && PeekToken(&cursor, text.end))
+	{
+		fileStatus = BAD_FORMAT;
+	}
+	CloseInstanceText(&text);
+	if (fileStatus != SUCCESS)
+	{
+		FreeSolutionLines(lines);
+		return (fileStatus);
+	}
+	SortSolutionLines(lines);
+	return (SUCCESS);
+}
+
+void FreeSolutionLines(SolutionLines *lines)
+{
+	free(lines->lines[X]);
+	free(lines->lines[Y]);
+	lines->lines[X] = NULL;
+	lines->lines[Y] = NULL;
+}
+
+/* Number of lines strictly below the doubled coordinate, and whether one lies on it */
+int CountDoubledBelow(const int64_t *lines, int numberOfLines, int64_t doubled, int *isOnLine)
+{
+	if (numberOfLines == 0)
+	{
+		return (0);
+	}
+	const int64_t *base = lines;
+	int n = numberOfLines;
+	while (n > 1)
+	{
+		int half = n / 2;
+		base = base[half] < doubled ? base + half : base;
+		n -= half;
+	}
+	int below = (int)(base - lines) + (*base < doubled);
+	*isOnLine |= below < numberOfLines && lines[below] == doubled;
+	return (below);
+}
+
+/* Compute the cell keys of one chunk of points */
+void ComputeCellKeys(void *context, int task, int worker)
+{
+	const VerifyBatch *batch = (const VerifyBatch *)context;
+	const SolutionLines *lines = batch->lines;
+	long long from = (long long)task * VERIFY_CHUNK;
+	long long to = from + VERIFY_CHUNK < batch->numberOfPoints ? from + VERIFY_CHUNK : batch->numberOfPoints;
+	int pointsOnLines = 0;
+	long long index = from;
+	while (index < to)
+	{
+		int isOnLine = 0;
+		uint64_t slab = (uint64_t)CountDoubledBelow(lines->lines[X], lines->numberOfLines[X], 2 * (int64_t)batch->xValues[index], &isOnLine);
+		uint64_t band = (uint64_t)CountDoubledBelow(lines->lines[Y], lines->numberOfLines[Y], 2 * (int64_t)batch->yValues[index], &isOnLine);
+		batch->keys[index] = slab << 32 | band;
+		pointsOnLines += isOnLine;
+		index++;
+	}
+	batch->pointsOnLines[worker] += pointsOnLines;
+}
+
+/* Check that the lines separate the points, returns whether they do */
+int VerifyLines(const int *xValues, const int *yValues, int numberOfPoints, const SolutionLines *lines, int numberOfWorkers, Verification *result)
+{
+	result->numberOfLines = lines->numberOfLines[X] + lines->numberOfLines[Y];
+	result->sharedPoints = 0;
+	result->pointsOnLines = 0;
+	result->firstPoint = -1;
+	result->secondPoint = -1;
+	int numberOfChunks = (int)(((long long)numberOfPoints + VERIFY_CHUNK - 1) / VERIFY_CHUNK);
+	if (numberOfChunks == 0)
+	{
+		return (1);
+	}
+	if (numberOfWorkers < 1)
+	{
+		numberOfWorkers = GetNumberOfCores();
+	}
+	if (numberOfWorkers > numberOfChunks)
+	{
+		numberOfWorkers = numberOfChunks;
+	}
+
+	VerifyBatch batch;
+	batch.xValues = xValues;
+	batch.yValues = yValues;
+	batch.numberOfPoints = numberOfPoints;
+	batch.lines = lines;
+	batch.keys = (uint64_t *)AllocateStorage(sizeof(uint64_t) * (size_t)numberOfPoints);
+	batch.pointsOnLines = (int *)AllocateClearedStorage((size_t)numberOfWorkers, sizeof(int));
+	int *tasks = (int *)AllocateStorage(sizeof(int) * (size_t)numberOfChunks);
+	int index = 0;
+	while (index < numberOfChunks)
+	{
+		tasks[index] = index;
+		index++;
+	}
+	RunWorkPool(numberOfWorkers, tasks, numberOfChunks, &ComputeCellKeys, &batch);
+	index = 0;
+	while (index < numberOfWorkers)
+	{
+		result->pointsOnLines += batch.pointsOnLines[index];
+		index++;
+	}
+
+	uint64_t *sorted = (uint64_t *)AllocateStorage(sizeof(uint64_t) * 2 * (size_t)numberOfPoints);
+	memcpy(sorted, batch.keys, sizeof(uint64_t) * (size_t)numberOfPoints);
+	RadixSortKeys(sorted, NULL, sorted + numberOfPoints, NULL, (size_t)numberOfPoints, numberOfWorkers);
+	int shared = -1;
+	index = 1;
+	while (index < numberOfPoints)
+	{
+		if (sorted[index] == sorted[index - 1])
+		{
+			result->sharedPoints++;
+			shared = shared < 0 ? index : shared;
+		}
+		index++;
+	}
+
+	/* name the first two points of the first shared cell */
+	if (shared >= 0)
+	{
+		index = 0;
+		while (index < numberOfPoints && result->secondPoint < 0)
+		{
+			if (batch.keys[index] == sorted[shared])
+			{
+				if (result->firstPoint < 0)
+				{
+					result->firstPoint = index;
+				}
+				else
+				{
+					result->secondPoint = index;
+				}
+			}
+			index++;
+		}
+	}
+	free(sorted);
+	free(tasks);
+	free(batch.pointsOnLines);
+	free(batch.keys);
+	return (result->sharedPoints == 0 && result->pointsOnLines == 0);
+}
+
+/* Check the solution held by a solved solver */
+int VerifySolution(Solver *solver, Verification *result)
+{
+	SolutionLines lines;
+	GetSolverLines(solver, &lines);
+	int isValid = VerifyLines(solver->myValues[X], solver->myValues[Y], solver->myNumberOfPoints, &lines, solver->myRestartWorkers, result);
+	FreeSolutionLines(&lines);
+	return (isValid);
+}
+
+void ReportVerification(const char *fileName, const int *xValues, const int *yValues, const Verification *result)
+{
+	int isValid = result->sharedPoints == 0 && result->pointsOnLines == 0;
+	printf(VERIFY_REPORT, fileName, isValid ? "valid" : "INVALID", result->numberOfLines, result->sharedPoints, result->pointsOnLines);
+	if (result->secondPoint >= 0)
+	{
+		printf(VERIFY_PAIR_REPORT, fileName, xValues[result->firstPoint], yValues[result->firstPoint],
+			xValues[result->secondPoint], yValues[result->secondPoint]);
+	}
+}
+
+/* Check a solution file against an instance file, returns 0 when the solution is valid */
+int VerifySolutionFile(Solver *solver, char *instanceName, char *solutionName)
+{
+	int fileStatus = ReadInputFile(solver, instanceName);
+	if (fileStatus != SUCCESS)
+	{
+		ReportFileStatus(fileStatus, instanceName);
+		(void)fprintf(stderr, VERIFY_ERR, solutionName, instanceName);
+		return (1);
+	}
+	SolutionLines lines;
+	fileStatus = ReadSolutionFile(solutionName, &lines);
+	if (fileStatus != SUCCESS)
+	{
+		ReportFileStatus(fileStatus, solutionName);
+		(void)fprintf(stderr, VERIFY_ERR, solutionName, instanceName);
+		return (1);
+	}
+	Verification result;
+	int isValid = VerifyLines(solver->myValues[X], solver->myValues[Y], solver->myNumberOfPoints, &lines, solver->myRestartWorkers, &result);
+	ReportVerification(solutionName, solver->myValues[X], solver->myValues[Y], &result);
+	FreeSolutionLines(&lines);
+	return (isValid ? 0 : 1);
+}
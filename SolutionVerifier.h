@@ -0,0 +1,55 @@
+#pragma once
+#ifndef SOLUTION_VERIFIER_H
+#define  SOLUTION_VERIFIER_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	VERIFY_REPORT "Verify %s: %s, %d lines, %d points sharing a cell, %d points on a line\n"
+#define	VERIFY_PAIR_REPORT "Verify %s: points (%d, %d) and (%d, %d) share a cell\n"
+#define	VERIFY_ERR "Unable to verify %s against %s\n"
+
+/* Points per task of the work pool */
+#define	VERIFY_CHUNK	(1 << 16)
+
+/* Type Definitions */
+
+/* Lines of a solution by axis, as twice their coordinate, sorted */
+typedef struct solutionLines
+{
+	int64_t *lines[2];
+	int numberOfLines[2];
+} SolutionLines;
+
+/* Outcome of a verification, the first and second point of a shared cell are -1 when there is none */
+typedef struct verification
+{
+	int numberOfLines;
+	int sharedPoints;
+	int pointsOnLines;
+	int firstPoint;
+	int secondPoint;
+} Verification;
+
+/* Shared state of the workers computing the cell keys */
+typedef struct verifyBatch
+{
+	const int *xValues;
+	const int *yValues;
+	int numberOfPoints;
+	const SolutionLines *lines;
+	uint64_t *keys;
+	int *pointsOnLines;
+} VerifyBatch;
+
+/* Functions */
+void GetSolverLines(Solver *solver, SolutionLines *lines);
+int ReadSolutionFile(char *fileName, SolutionLines *lines);
+void FreeSolutionLines(SolutionLines *lines);
+int VerifyLines(const int *xValues, const int *yValues, int numberOfPoints, const SolutionLines *lines, int numberOfWorkers, Verification *result);
+int VerifySolution(Solver *solver, Verification *result);
+void ReportVerification(const char *fileName, const int *xValues, const int *yValues, const Verification *result);
+int VerifySolutionFile(Solver *solver, char *instanceName, char *solutionName);
+
+#endif
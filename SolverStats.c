@@ -0,0 +1,62 @@
+/* Solver statistics. A build with -DSEPARATING_LINES_STATS counts the work done
+* on the hot paths and times every phase of the pipeline, and writes one JSON
+* record per line for every solved instance. Without the definition the counters
+* compile to nothing and no record is written.
+*/
+
+#include "SeparatingLines.h"
+
+const char *myPhaseNames[NUMBER_OF_PHASES] = { "parse", "sort", "initialize", "candidates", "greedy", "optimize", "write" };
+
+/* Write a string as a JSON string literal */
+void WriteJsonString(FILE *out, const char *text)
+{
+	fputc('"', out);
+	while (*text != '\0')
+	{
+		unsigned char c = (unsigned char)*text;
+		if (c == '"' || c == '\\')
+		{
+			fputc('\\', out);
+			fputc(c, out);
+		}
+		else if (c < 0x20)
+		{
+			fprintf(out, "\\u%04x", c);
+		}
+		else
+		{
+			fputc(c, out);
+		}
+		text++;
+	}
+	fputc('"', out);
+}
+
+/* Write the statistics of the solved instance as a single line. The stream is locked
+ * for the whole record so that the workers of a batch never interleave their lines
+ */
+void WriteStatsRecord(Solver *solver, const char *fileName, FILE *out)
+{
+	const SolverStats *stats = &solver->myStats;
+	flockfile(out);
+	fprintf(out, "{\"instance\":");
+	WriteJsonString(out, fileName);
+	fprintf(out, ",\"engine\":\"%s\",\"points\":%d,\"lines\":%d,\"phases_ms\":{",
+		solver->myEngine == CELL_ENGINE ? "cell" : "pairwise", solver->myNumberOfPoints, CountCommittedLines(solver));
+	int phase = 0;
+	while (phase < NUMBER_OF_PHASES)
+	{
+		fprintf(out, "%s\"%s\":%.3f", phase > 0 ? "," : "", myPhaseNames[phase], stats->phaseTime[phase] * 1000);
+		phase++;
+	}
+	fprintf(out, "},\"check_connection_calls\":%lld,\"pairs_inspected\":%lld,\"points_inspected\":%lld",
+		stats->checkConnectionCalls, stats->pairsInspected, stats->pointsInspected);
+	fprintf(out, ",\"disconnect_calls\":%lld,\"points_moved\":%lld", stats->disconnectCalls, stats->pointsMoved);
+	fprintf(out, ",\"lines_committed\":%lld,\"lines_uncommitted_x\":%lld,\"lines_uncommitted_y\":%lld",
+		stats->linesCommitted, stats->linesUncommitted[X], stats->linesUncommitted[Y]);
+	fprintf(out, ",\"local_moves\":%lld,\"finished\":%s", stats->localMoves, solver->myIsFinished ? "true" : "false");
+	fprintf(out, ",\"lower_bound\":%d", solver->myBounds.best);
+	fprintf(out, ",\"allocation_bytes\":%lu}\n", (unsigned long)solver->myArena.allocatedBytes);
+	funlockfile(out);
+}
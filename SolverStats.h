@@ -0,0 +1,62 @@
+#pragma once
+#ifndef SOLVER_STATS_H
+#define  SOLVER_STATS_H
+
+/* Includes */
+#include <stdio.h>
+#include <stddef.h>
+
+/* Definitions */
+#define	STATS_FILE_ERR "Unable to open the statistics file %s\n"
+#define	STATS_DISABLED_ERR "Statistics are not compiled in, rebuild with -DSEPARATING_LINES_STATS\n"
+
+/* The counters cost nothing unless the build defines SEPARATING_LINES_STATS */
+#ifdef SEPARATING_LINES_STATS
+#define	STATS_ADD(solver, counter, value)	((solver)->myStats.counter += (value))
+#define	STATS_START(timer)	double timer = GetWallClock()
+#define	STATS_LAP(solver, phase, timer)	do { double statsNow = GetWallClock(); (solver)->myStats.phaseTime[phase] += statsNow - (timer); (timer) = statsNow; } while (0)
+#else
+#define	STATS_ADD(solver, counter, value)	((void)0)
+#define	STATS_START(timer)	((void)0)
+#define	STATS_LAP(solver, phase, timer)	((void)0)
+#endif
+
+/* Type Definitions */
+
+/* Steps of the solver pipeline, timed separately */
+typedef enum phase
+{
+	PARSE_PHASE,
+	SORT_PHASE,
+	INITIALIZE_PHASE,
+	CANDIDATE_PHASE,
+	GREEDY_PHASE,
+	OPTIMIZE_PHASE,
+	WRITE_PHASE,
+	NUMBER_OF_PHASES
+} Phase;
+
+/* Hot path counters of one instance */
+typedef struct solverStats
+{
+	double phaseTime[NUMBER_OF_PHASES];
+	long long checkConnectionCalls;
+
+	/* pairs of points tested by the pairwise engine, points scanned by the cell engine */
+	long long pairsInspected;
+	long long pointsInspected;
+
+	/* rows cleared by the pairwise engine, points moved to a new cell by the cell engine */
+	long long disconnectCalls;
+	long long pointsMoved;
+
+	long long linesCommitted;
+	long long linesUncommitted[2];
+
+	/* pairs of lines replaced by one line by the local optimization */
+	long long localMoves;
+} SolverStats;
+
+extern const char *myPhaseNames[NUMBER_OF_PHASES];
+
+#endif
@@ -0,0 +1,219 @@
+/* Spatial decomposition. The points are cut by a few coarse lines into a grid of
+* parts: the larger side is halved until there are enough parts, so the cuts of an
+* axis are median splits of its ranks, the way AddLines splits a range. Every part
+* is solved on its own by the usual pipeline, on the work pool, each worker with a
+* solver sized by the largest part it solves. A line of a part lies in the gap
+* right after its left point, which is also a gap of the whole instance that splits
+* the points of the part the same way. The coarse lines and the lines of all the
+* parts separate every pair of points, and since each line crosses the whole
+* instance many of them are not needed anymore: the boundary pass, the redundant
+* line removal and the local optimization when asked, runs on the whole instance.
+*/
+
+#include "SpatialDecomposition.h"
+#include "MultiStart.h"
+#include "LowerBounds.h"
+#include "RadixSort.h"
+#include "WorkPool.h"
+
+/* Part of the point with the given id, slab by slab and band by band inside a slab */
+int GetPartOf(const Decomposition *decomposition, int id)
+{
+	const Solver *solver = decomposition->source;
+	long long n = solver->myNumberOfPoints;
+	int slab = (int)((long long)solver->myRanks[X][id] * decomposition->numberOfSlabs / n);
+	int band = (int)((long long)solver->myRanks[Y][id] * decomposition->numberOfBands / n);
+	return (slab * decomposition->numberOfBands + band);
+}
+
+/* Solve one part on the solver of the worker and keep its lines in the ranks of the whole instance */
+void SolvePart(void *context, int task, int worker)
+{
+	Decomposition *decomposition = (Decomposition *)context;
+	const Solver *source = decomposition->source;
+	Solver *solver = &decomposition->solvers[worker];
+	const int *ids = &decomposition->partIds[decomposition->partStart[task]];
+	int count = decomposition->partStart[task + 1] - decomposition->partStart[task];
+	int *lines = &decomposition->lines[2 * decomposition->partStart[task]];
+	decomposition->numberOfLines[task] = 0;
+	if (count < 2)
+	{
+		return;
+	}
+
+	ResetSolverStorage(solver);
+	solver->myNumberOfPoints = count;
+	AllocateSolverStorage(solver, count);
+	int index = 0;
+	while (index < count)
+	{
+		solver->myValues[X][index] = source->myValues[X][ids[index]];
+		solver->myValues[Y][index] = source->myValues[Y][ids[index]];
+		index++;
+	}
+	Solve(solver);
+
+	index = 0;
+	while (index < solver->myNumberOfLines)
+	{
+		Line *l = solver->myCommittedLines[index];
+		if (l->isCommitted)
+		{
+			int left = ids[solver->mySortedIds[l->lineAxis][l->leftRank]];
+			lines[decomposition->numberOfLines[task]++] = 2 * source->myRanks[l->lineAxis][left] + l->lineAxis;
+		}
+		index++;
+	}
+}
+
+/* Add the line to the result unless it is there already */
+void AddPartLine(RestartResult *result, unsigned char *isTaken, int line)
+{
+	if (!isTaken[line])
+	{
+		isTaken[line] = 1;
+		result->lines[result->numberOfLines++] = line;
+	}
+}
+
+/* Add the coarse lines of one axis, the gaps before the first rank of every part but the first */
+void AddCoarseLines(RestartResult *result, unsigned char *isTaken, int axis, int numberOfParts, int numberOfPoints)
+{
+	int part = 1;
+	while (part < numberOfParts)
+	{
+		int rank = (int)(((long long)part * numberOfPoints + numberOfParts - 1) / numberOfParts);
+		if (rank > 0 && rank < numberOfPoints)
+		{
+			AddPartLine(result, isTaken, 2 * (rank - 1) + axis);
+		}
+		part++;
+	}
+}
+
+/* Solve the instance held by the solver as a grid of parts, at least myNumberOfParts of them.
+ * The number is rounded up to the power of two actually used
+ */
+void SolveDecomposed(Solver *solver)
+{
+	int n = solver->myNumberOfPoints;
+	SortInputPoints(solver);
+	ComputeLowerBounds(solver);
+
+	Decomposition decomposition;
+	decomposition.source = solver;
+	decomposition.numberOfSlabs = 1;
+	decomposition.numberOfBands = 1;
+	while (decomposition.numberOfSlabs * decomposition.numberOfBands < solver->myNumberOfParts)
+	{
+		if (decomposition.numberOfSlabs <= decomposition.numberOfBands)
+		{
+			decomposition.numberOfSlabs *= 2;
+		}
+		else
+		{
+			decomposition.numberOfBands *= 2;
+		}
+	}
+	int numberOfParts = decomposition.numberOfSlabs * decomposition.numberOfBands;
+	solver->myNumberOfParts = numberOfParts;
+
+	/* group the ids by part, in id order inside a part */
+	decomposition.partStart = (int *)AllocateClearedStorage((size_t)numberOfParts + 1, sizeof(int));
+	decomposition.partIds = (int *)AllocateStorage(sizeof(int) * (size_t)(n + 1));
+	int *next = (int *)AllocateStorage(sizeof(int) * (size_t)numberOfParts);
+	int id = 0;
+	while (id < n)
+	{
+		decomposition.partStart[GetPartOf(&decomposition, id) + 1]++;
+		id++;
+	}
+	int part = 0;
+	while (part < numberOfParts)
+	{
+		decomposition.partStart[part + 1] += decomposition.partStart[part];
+		next[part] = decomposition.partStart[part];
+		part++;
+	}
+	id = 0;
+	while (id < n)
+	{
+		decomposition.partIds[next[GetPartOf(&decomposition, id)]++] = id;
+		id++;
+	}
+	decomposition.lines = (int *)AllocateStorage(sizeof(int) * 2 * (size_t)(n + 1));
+	decomposition.numberOfLines = (int *)AllocateClearedStorage((size_t)numberOfParts, sizeof(int));
+
+	/* the largest parts go first */
+	uint64_t *keys = (uint64_t *)AllocateStorage(sizeof(uint64_t) * 2 * (size_t)numberOfParts);
+	int *tasks = (int *)AllocateStorage(sizeof(int) * 2 * (size_t)numberOfParts);
+	part = 0;
+	while (part < numberOfParts)
+	{
+		keys[part] = (uint64_t)(n - (decomposition.partStart[part + 1] - decomposition.partStart[part]));
+		tasks[part] = part;
+		part++;
+	}
+	RadixSortKeys(keys, tasks, keys + numberOfParts, tasks + numberOfParts, (size_t)numberOfParts, 1);
+
+	int numberOfWorkers = solver->myRestartWorkers;
+	if (numberOfWorkers < 1)
+	{
+		numberOfWorkers = GetNumberOfCores();
+	}
+	if (numberOfWorkers > numberOfParts)
+	{
+		numberOfWorkers = numberOfParts;
+	}
+	decomposition.solvers = (Solver *)AllocateStorage(sizeof(Solver) * (size_t)numberOfWorkers);
+	int index = 0;
+	while (index < numberOfWorkers)
+	{
+		CopySolverSettings(&decomposition.solvers[index], solver);
+		decomposition.solvers[index].myNumberOfParts = 0;
+		index++;
+	}
+	RunWorkPool(numberOfWorkers, tasks, numberOfParts, &SolvePart, &decomposition);
+
+	/* the coarse lines and the lines of every part, each gap once */
+	RestartResult result;
+	result.restart = 0;
+	result.numberOfLines = 0;
+	result.lines = (int *)AllocateStorage(sizeof(int) * 2 * (size_t)(n + 1));
+	unsigned char *isTaken = (unsigned char *)AllocateClearedStorage(2 * (size_t)(n + 1), 1);
+	AddCoarseLines(&result, isTaken, X, decomposition.numberOfSlabs, n);
+	AddCoarseLines(&result, isTaken, Y, decomposition.numberOfBands, n);
+	part = 0;
+	while (part < numberOfParts)
+	{
+		const int *lines = &decomposition.lines[2 * decomposition.partStart[part]];
+		index = 0;
+		while (index < decomposition.numberOfLines[part])
+		{
+			AddPartLine(&result, isTaken, lines[index]);
+			index++;
+		}
+		part++;
+	}
+	CommitResultLines(solver, &result);
+	solver->myNumberOfPartLines = result.numberOfLines;
+	ImproveSolution(solver);
+	solver->myIsFinished = 1;
+
+	index = 0;
+	while (index < numberOfWorkers)
+	{
+		FreeSolver(&decomposition.solvers[index]);
+		index++;
+	}
+	free(decomposition.solvers);
+	free(isTaken);
+	free(result.lines);
+	free(tasks);
+	free(keys);
+	free(decomposition.numberOfLines);
+	free(decomposition.lines);
+	free(next);
+	free(decomposition.partIds);
+	free(decomposition.partStart);
+}
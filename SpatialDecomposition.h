@@ -0,0 +1,36 @@
+#pragma once
+#ifndef SPATIAL_DECOMPOSITION_H
+#define  SPATIAL_DECOMPOSITION_H
+
+/* Includes */
+#include "SeparatingLines.h"
+
+/* Definitions */
+#define	DECOMPOSE_REPORT "Decomposed %s: %d parts, %d lines before and %d after the boundary pass\n"
+#define	DECOMPOSE_MODE_ERR "The spatial decomposition runs the greedy pipeline on every part, without -x or -t\n"
+
+/* Type Definitions */
+
+/* Shared state of the workers solving the parts, every worker owns a solver reused from part to part */
+typedef struct decomposition
+{
+	Solver *source;
+	Solver *solvers;
+	int numberOfSlabs;
+	int numberOfBands;
+
+	/* Ids of the points of every part, those of part p from partStart[p] to partStart[p + 1] - 1 */
+	int *partStart;
+	int *partIds;
+
+	/* Lines found in every part as 2 * leftRank + axis in the ranks of the whole instance,
+	 * those of part p from 2 * partStart[p] onwards
+	 */
+	int *lines;
+	int *numberOfLines;
+} Decomposition;
+
+/* Functions */
+void SolveDecomposed(Solver *solver);
+
+#endif
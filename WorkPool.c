@@ -0,0 +1,147 @@
+/* A small work stealing pool. The tasks are dealt round robin to one queue per
+* worker in the order given by the caller, so passing the most expensive tasks
+* first spreads them over all the workers. A worker runs the tasks of its own
+* queue from the head, and once it is empty steals from the tail of the other
+* queues, so a worker stuck on a long task never holds back the short tasks
+* queued behind it.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "SeparatingLines.h"
+#include "WorkPool.h"
+
+/* Get the number of cores available to the process */
+int GetNumberOfCores()
+{
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cores < 1)
+	{
+		return (1);
+	}
+	return ((int)cores);
+}
+
+/* Take the next task of the worker's own queue, -1 if it is empty */
+int PopTask(WorkQueue *queue)
+{
+	int task = -1;
+	pthread_mutex_lock(&queue->lock);
+	if (queue->head < queue->tail)
+	{
+		task = queue->tasks[queue->head++];
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return (task);
+}
+
+/* Take the last task of another worker's queue, -1 if it is empty */
+int StealTask(WorkQueue *queue)
+{
+	int task = -1;
+	pthread_mutex_lock(&queue->lock);
+	if (queue->head < queue->tail)
+	{
+		task = queue->tasks[--queue->tail];
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return (task);
+}
+
+/* Run tasks until every queue is empty. No task is ever added once the pool runs,
+ * so a worker that finds all the queues empty is done
+ */
+void *RunWorker(void *argument)
+{
+	Worker *worker = (Worker *)argument;
+	WorkPool *pool = worker->pool;
+	for (;;)
+	{
+		int task = PopTask(&pool->queues[worker->index]);
+		int victim = 1;
+		while (task < 0 && victim < pool->numberOfWorkers)
+		{
+			task = StealTask(&pool->queues[(worker->index + victim) % pool->numberOfWorkers]);
+			victim++;
+		}
+		if (task < 0)
+		{
+			return (NULL);
+		}
+		pool->run(pool->context, task, worker->index);
+	}
+}
+
+/* Run the tasks on the given number of workers and wait for all of them. Worker 0 is
+ * the calling thread, so a single worker runs everything in order without any thread
+ */
+void RunWorkPool(int numberOfWorkers, const int *tasks, int numberOfTasks, WorkTask run, void *context)
+{
+	if (numberOfWorkers > numberOfTasks)
+	{
+		numberOfWorkers = numberOfTasks;
+	}
+	if (numberOfWorkers < 1)
+	{
+		return;
+	}
+
+	WorkPool pool;
+	pool.numberOfWorkers = numberOfWorkers;
+	pool.run = run;
+	pool.context = context;
+	pool.queues = (WorkQueue *)AllocateStorage(sizeof(WorkQueue) * numberOfWorkers);
+	pool.workers = (Worker *)AllocateStorage(sizeof(Worker) * numberOfWorkers);
+	int *queued = (int *)AllocateStorage(sizeof(int) * numberOfTasks);
+
+	/* deal the tasks round robin, queue w holds tasks w, w + workers, ... */
+	int w = 0;
+	int offset = 0;
+	while (w < numberOfWorkers)
+	{
+		WorkQueue *queue = &pool.queues[w];
+		queue->tasks = queued + offset;
+		queue->head = 0;
+		queue->tail = 0;
+		int i = w;
+		while (i < numberOfTasks)
+		{
+			queue->tasks[queue->tail++] = tasks[i];
+			i += numberOfWorkers;
+		}
+		offset += queue->tail;
+		pthread_mutex_init(&queue->lock, NULL);
+		pool.workers[w].pool = &pool;
+		pool.workers[w].index = w;
+		w++;
+	}
+
+	w = 1;
+	while (w < numberOfWorkers)
+	{
+		if (pthread_create(&pool.workers[w].thread, NULL, &RunWorker, &pool.workers[w]) != 0)
+		{
+			/* the remaining queues are drained by stealing */
+			break;
+		}
+		w++;
+	}
+	int started = w;
+	RunWorker(&pool.workers[0]);
+	w = 1;
+	while (w < started)
+	{
+		pthread_join(pool.workers[w].thread, NULL);
+		w++;
+	}
+
+	w = 0;
+	while (w < numberOfWorkers)
+	{
+		pthread_mutex_destroy(&pool.queues[w].lock);
+		w++;
+	}
+	free(queued);
+	free(pool.workers);
+	free(pool.queues);
+}
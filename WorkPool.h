@@ -0,0 +1,45 @@
+#pragma once
+#ifndef WORK_POOL_H
+#define  WORK_POOL_H
+
+/* Includes */
+#include <pthread.h>
+
+/* Type Definitions */
+
+/* Runs one task on behalf of a worker */
+typedef void (*WorkTask)(void *context, int task, int worker);
+
+/* Tasks owned by one worker. The owner takes from the head, thieves take from the tail */
+typedef struct workQueue
+{
+	int *tasks;
+	int head;
+	int tail;
+	pthread_mutex_t lock;
+} WorkQueue;
+
+typedef struct workPool WorkPool;
+
+/* A worker thread of the pool */
+typedef struct worker
+{
+	WorkPool *pool;
+	int index;
+	pthread_t thread;
+} Worker;
+
+struct workPool
+{
+	int numberOfWorkers;
+	WorkQueue *queues;
+	Worker *workers;
+	WorkTask run;
+	void *context;
+};
+
+/* Functions */
+int GetNumberOfCores();
+void RunWorkPool(int numberOfWorkers, const int *tasks, int numberOfTasks, WorkTask run, void *context);
+
+#endif